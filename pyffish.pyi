@@ -16,6 +16,15 @@ VALUE_MATE: int
 
 class error(Exception): ...
 
+class Board:
+    def __init__(self, variant: str, fen: str = "startpos", movelist: list[str] = [], chess960: bool = False) -> None: ...
+    def push(self, move: str) -> None: ...
+    def pop(self) -> str: ...
+    def legal_moves(self) -> list[str]: ...
+    def fen(self, sfen: bool = False, show_promoted: bool = False, count_started: int = 0) -> str: ...
+    def result(self) -> int | None: ...
+    def urbino_scores(self) -> tuple[int, int]: ...
+
 def version() -> tuple[int, int, int]: ...
 def info() -> str: ...
 def variants() -> list[str]: ...
@@ -37,3 +46,5 @@ def is_optional_game_end(variant: str, fen: str, movelist: list[str], chess960:
 def has_insufficient_material(variant: str, fen: str, movelist: list[str], chess960: bool = False) -> tuple[bool, bool]: ...
 def validate_fen(fen: str, variant: str, chess960: bool = False) -> int: ...
 def get_fog_fen(fen: str, variant: str, chess960: bool = False) -> str: ...
+def legal_moves_batch(variant: str, items: list[tuple[str, list[str]]], chess960: bool = False) -> list[list[str]]: ...
+def game_result_batch(variant: str, items: list[tuple[str, list[str]]], chess960: bool = False) -> list[int | None]: ...
@@ -16,12 +16,22 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
 #include <fstream>
+#include <functional>
+#include <iomanip>
 #include <iostream>
 #include <istream>
+#include <sstream>
 #include <vector>
 
+#include "evaluate.h"
+#include "movegen.h"
 #include "position.h"
+#include "thread.h"
 #include "uci.h"
 
 using namespace std;
@@ -91,10 +101,61 @@ const vector<string> Defaults = {
   "setoption name UCI_Chess960 value false"
 };
 
+// Urbino positions from the reference game of test_urbino_movegen.sh and from
+// self-play games: the architects being placed, crowded midgames with many
+// districts, and late positions where both sides have few buildings left or
+// can only pass. Some of the late ones hold monuments.
+const vector<string> UrbinoDefaults = {
+  // Opening
+  "9/9/9/9/9/9/9/9/9[TTTPPPPPPHHHHHHHHHHHHHHHHHHAtttpppppphhhhhhhhhhhhhhhhhha] w - - 0 1",
+  "9/9/9/6a2/9/9/A8/9/9[TTTPPPPPPHHHHHHHHHHHHHHHHHHtttpppppphhhhhhhhhhhhhhhhhh] b - - 1 2",
+  "9/3a5/3H5/9/9/9/9/8A/9[TTTPPPPPPHHHHHHHHHHHHHHHHHtttpppppphhhhhhhhhhhhhhhhhh] b - - 1 2",
+  "4p4/9/9/9/6P2/T8/4tpT2/5A3/4a4[TPPPPPHHHHHHHHHHHHHHHHHHttpppphhhhhhhhhhhhhhhhhh] w e - 6 5",
+
+  // Midgame
+  "3A5/9/9/3hP1h1a/5h3/6H2/9/9/9[TTTPPPPPHHHHHHHHHHHHHHHHHtttpppppphhhhhhhhhhhhhhh] w - - 6 5",
+  "6A2/7p1/3H2T2/3T2p2/6h2/9/9/7a1/9[TPPPPPPHHHHHHHHHHHHHHHHHtttpppphhhhhhhhhhhhhhhhh] w - - 6 5",
+  "9/7hP/4H1h1a/3hP1hH1/5h2h/6H2/9/9/4A4[TTTPPPPHHHHHHHHHHHHHHHtttpppppphhhhhhhhhhhh] w E - 12 8",
+  "9/3t5/9/9/3A1h3/4Ph3/1h1PHT3/h3P4/2T2h3[TPPPHHHHHHHHHHHHHHHHHttpppppphhhhhhhhhhhhha] w C - 13 8",
+  "5paT1/7p1/3HH1T2/P2T2p1A/t5h2/2h6/9/9/9[PPPPPHHHHHHHHHHHHHHHHttppphhhhhhhhhhhhhhhh] w fg - 12 8",
+  "4p4/5h3/9/6H2/6PHA/T8/4tpT2/3H3h1/4a3h[TPPPPPHHHHHHHHHHHHHHHttpppphhhhhhhhhhhhhhh] w e - 12 8",
+  "9/7hP/4H1h2/3hP1hH1/a4h2h/6H2/6H2/h2Hh4/AHh6[TTTPPPPHHHHHHHHHHHHtttpppppphhhhhhhhh] w B - 18 11",
+  "9/3t5/9/9/4hh3/4Ph3/hh1PHTP2/h2TP4/AhT2hP2[PHHHHHHHHHHHHHHHHHttpppppphhhhhhhhhha] w CG - 19 11",
+  "4p4/1t3h3/1h4H2/1T4H2/P1hA2PH1/T8/4tpT2/3H3h1/2a5h[PPPPHHHHHHHHHHHHHHtpppphhhhhhhhhhhhh] w e - 18 11",
+  "9/7hP/4H1h2/3hP1hH1/AtH2h2h/ap3TH2/P5H2/h2Hh4/1Hh1p4[TTPPPHHHHHHHHHHHttpppphhhhhhhhh] w B - 24 14",
+  "9/3t5/9/9/pt1Ahh3/tP1HPh3/hh1PHTPH1/h2TP4/1hT2hP2[HHHHHHHHHHHHHHHppppphhhhhhhhhha] w CG - 25 14",
+  "3ap4/1t3hP2/1h3PH2/1T1p2H2/P1hAt1PH1/T1P1p4/4tpT2/3H3h1/8h[PHHHHHHHHHHHHHHpphhhhhhhhhhhhh] w de - 24 14",
+  "9/3t5/1A7/1p7/ptp1hh3/tP1HPh3/hh1PHTPH1/h2TP2HH/1hT2hP2[HHHHHHHHHHHHHppphhhhhhhhhha] w CG - 29 16",
+  "9/1pH4hP/2AtH1h2/Ha1hP1hH1/1tH2h2h/1p3TH2/P5H2/h2Hh4/1Hh1p4[TTPPPHHHHHHHHHtppphhhhhhhhh] w B - 28 16",
+
+  // Late game and pass endgames
+  "1AH2p1T1/1h1h1H1p1/a2HH1T2/PH1T2p2/t1h3h2/2h6/9/9/9[PPPPPHHHHHHHHHHHHHttppphhhhhhhhhhhhh] w f - 18 11",
+  "2a1p4/1t1P1hP2/1hp1APH2/1T1ph1H2/P1h1t1PH1/T1P1p4/4tpT2/3H3h1/8h[HHHHHHHHHHHHHHphhhhhhhhhhhh] w ce - 28 16",
+  "2a1h4/1pH4hP/H1AtH1h2/H2hP1hH1/1tH2h2h/1p3TH2/P5H2/h2Hh4/1Hh1p4[TTPPPHHHHHHHHtppphhhhhhhh] w Bce - 30 17",
+  "3hh1HHH/3thh1Hh/2ph1phA1/hphp3HH/ptp1hhHH1/tP1HPhHHH/hh1PHTPHH/h2TP2HH/1hT2hP1H[ha] b CGIde - 54 28",
+  "AtaTh4/1pH4hP/H2tH1h2/H2hP1hH1/1tH2h2h/1p3TH2/P5H2/h2Hh4/1Hh1p4[TPPPHHHHHHHHppphhhhhhhhh] w Bbce - 32 18",
+  "aAH2p1T1/Ph1h1H1p1/3HH1T2/PH1T2p2/t1h3h2/2h6/9/9/9[PPPPHHHHHHHHHHHHHttppphhhhhhhhhhhhh] w af - 20 12",
+  "H1a1p4/1t1P1hP2/1hp2PH2/AT1ph1H2/P1h1t1PH1/T1P1p4/4tpT2/3H3h1/8h[HHHHHHHHHHHHHphhhhhhhhhhhh] b ce - 29 16",
+  "H1ahp4/1t1PAhP2/1hp2PH2/1T1ph1H2/P1h1t1PH1/T1P1p4/4tpT2/3H3h1/8h[HHHHHHHHHHHHHphhhhhhhhhhh] b cde - 31 17",
+  "3hh1HHH/3thh1Hh/2phhph2/hphpA2HH/ptp1hhHH1/tP1HPhHHH/hh1PHTPHH/h2TP2HH/1hT2hP1H[a] b CGIde - 56 29"
+};
+
 } // namespace
 
 namespace Stockfish {
 
+namespace {
+
+  // default_fens() returns the default bench positions of a variant
+  vector<string> default_fens(const string& varname, const Variant* variant) {
+
+    return varname == "chess"      ? Defaults
+         : variant->urbinoGating   ? UrbinoDefaults
+                                   : vector<string>{ variant->startFen };
+  }
+
+} // namespace
+
 /// setup_bench() builds a list of UCI commands to be run by bench. There
 /// are five parameters: TT size in MB, number of search threads that
 /// should be used, the limit value spent for each position, a file name
@@ -102,7 +163,7 @@ namespace Stockfish {
 /// depth, perft, nodes and movetime (in millisecs), and evaluation type
 /// mixed (default), classical, NNUE.
 ///
-/// bench -> search default positions up to depth 13
+/// bench -> search default positions up to depth 13 (depth 3 for Urbino)
 /// bench 64 1 15 -> search default positions up to depth 15 (TT = 64MB)
 /// bench 64 4 5000 current movetime -> search current position with 4 threads for 5 sec
 /// bench 64 1 100000 default nodes -> search default positions for 100K nodes each
@@ -130,7 +191,7 @@ vector<string> setup_bench(const Position& current, istream& is) {
   // Assign default values to missing arguments
   string ttSize    = (is >> token) ? token : "16";
   string threads   = (is >> token) ? token : "1";
-  string limit     = (is >> token) ? token : "13";
+  string limit     = (is >> token) ? token : variant->urbinoGating ? "3" : "13";
   string fenFile   = (is >> token) ? token : "default";
   string limitType = (is >> token) ? token : "depth";
   string evalType  = (is >> token) ? token : "mixed";
@@ -139,10 +200,7 @@ vector<string> setup_bench(const Position& current, istream& is) {
 
   if (fenFile == "default")
   {
-      if (varname != "chess")
-          fens.push_back(variant->startFen);
-      else
-          fens = Defaults;
+      fens = default_fens(varname, variant);
   }
 
   else if (fenFile == "current")
@@ -192,4 +250,390 @@ vector<string> setup_bench(const Position& current, istream& is) {
   return list;
 }
 
+
+/// microbench() is called when the engine receives the "microbench" command.
+/// It times the components of the search that dominate the Urbino profile
+/// over the default bench positions of a variant, and prints for each the
+/// mean time per operation, its standard deviation over the rounds, and the
+/// fastest round. Components that do not apply to the variant are skipped.
+/// Where Linux lets us read the hardware counters, it also prints the events
+/// per operation and per move generated.
+///
+/// microbench -> time the components on the positions of the current variant
+/// microbench urbino 20 -> time the Urbino components over 20 rounds
+
+void microbench(istream& is) {
+
+  string token, varname = string(Options["UCI_Variant"]);
+  int rounds = 10;
+
+  streampos args = is.tellg();
+  if ((is >> token) && variants.find(token) != variants.end())
+      varname = token;
+  else
+      is.seekg(args);
+
+  is >> rounds;
+  rounds = std::max(rounds, 2);
+
+  const Variant* variant = variants.find(varname)->second;
+  Thread* th = Threads.main();
+  th->wait_for_search_finished();
+
+  // Set up the corpus, without the moves and options of the bench list. The
+  // legal moves are generated up front, so that the components that play
+  // them do not time the move generator.
+  std::deque<StateInfo> states;
+  std::deque<Position> positions;
+  vector<vector<Move>> legalMoves;
+
+  for (const string& entry : default_fens(varname, variant))
+      if (entry.find("setoption") == string::npos)
+      {
+          states.emplace_back();
+          positions.emplace_back();
+          positions.back().set(variant, entry.substr(0, entry.find(" moves")), false, &states.back(), th);
+          legalMoves.emplace_back();
+          for (const auto& m : MoveList<LEGAL>(positions.back()))
+              legalMoves.back().push_back(m);
+      }
+
+  bool urbino = variant->urbinoGating;
+  vector<ExtMove> moveList(MAX_MOVES);
+  int64_t sink = 0, generated = 0;
+
+  // Each component runs on all positions once per round, and returns the
+  // number of operations it did
+  struct Component {
+    string name;
+    bool urbinoOnly;
+    std::function<int64_t(Position&, const vector<Move>&)> run;
+  };
+
+  const vector<Component> components = {
+    { "generate<QUIETS>", false, [&](Position& pos, const vector<Move>&) {
+        if (pos.checkers())
+            return int64_t(0);
+        generated += generate<QUIETS>(pos, moveList.data()) - moveList.data();
+        return int64_t(1);
+    }},
+    { "do_move+undo_move", false, [&](Position& pos, const vector<Move>& legal) {
+        StateInfo st;
+        int64_t n = 0;
+        for (Move m : legal)
+        {
+            pos.do_move(m, st);
+            pos.undo_move(m);
+            ++n;
+        }
+        return n;
+    }},
+    { "urbino_legal_build", true, [&](Position& pos, const vector<Move>&) {
+        // Clear the per-state cache, so that every square is computed
+        StateInfo* st = pos.state();
+        Color us = pos.side_to_move();
+        Bitboard legal = st->urbinoLegalBuildCache[us], illegal = st->urbinoIllegalBuildCache[us];
+        st->urbinoLegalBuildCache[us] = st->urbinoIllegalBuildCache[us] = 0;
+        int64_t n = 0;
+        for (Bitboard b = pos.board_bb() & ~pos.pieces(); b; ++n)
+            sink += pos.urbino_legal_build(us, pop_lsb(b));
+        st->urbinoLegalBuildCache[us] = legal;
+        st->urbinoIllegalBuildCache[us] = illegal;
+        return n;
+    }},
+    { "urbino_update_blocks+undo", true, [&](Position& pos, const vector<Move>& legal) {
+        // Builds of the legal moves, undone with a fresh undo record in the
+        // state as in do_move()
+        UrbinoUndo saved = pos.state()->urbinoUndo;
+        int64_t n = 0;
+        for (Move m : legal)
+            if (is_gating(m))
+            {
+                pos.state()->urbinoUndo = {};
+                pos.urbino_update_blocks(gating_square(m), pos.side_to_move(), gating_type(m), pos.state()->urbinoUndo);
+                pos.undo_move_urbino();
+                ++n;
+            }
+        pos.state()->urbinoUndo = saved;
+        return n;
+    }},
+    { "urbino_scores", true, [&](Position& pos, const vector<Move>&) {
+        int w, b;
+        pos.urbino_scores(w, b);
+        sink += w - b;
+        return int64_t(1);
+    }},
+    { "evaluate", false, [&](Position& pos, const vector<Move>&) {
+        // Invalidate the cached evaluation, so that it is computed
+        th->evalCache[pos.building_key()]->key = 0;
+        sink += Eval::evaluate(pos);
+        return int64_t(1);
+    }}
+  };
+
+  // Hardware counters add columns per operation, if the system provides them
+  PerfCounters perf;
+  perf.start();
+  perf.stop();
+  const bool counters = perf.available();
+  const char* eventNames[] = { "cycles", "instr", "L1d miss", "LLC miss", "br miss" };
+
+  std::stringstream header;
+  header << std::left << std::setw(28) << "component" << std::right
+         << std::setw(12) << "ns/op" << std::setw(10) << "stddev"
+         << std::setw(12) << "min ns/op" << std::setw(12) << "ops/round";
+  for (int e = 0; counters && e < PerfCounters::EVENT_NB; ++e)
+      if (perf.available(PerfCounters::Event(e)))
+          header << std::setw(10) << eventNames[e];
+
+  sync_cout << "Microbench of " << varname << " on " << positions.size() << " positions, "
+            << rounds << " rounds\n\n" << header.str() << sync_endl;
+
+  double genNs = 0, genEvents[PerfCounters::EVENT_NB] = {};
+  int64_t genMoves = 0;
+
+  for (const Component& c : components)
+  {
+      if (c.urbinoOnly && !urbino)
+          continue;
+
+      vector<double> nsPerOp;
+      int64_t ops = 0, totalOps = 0;
+
+      // One untimed round to warm up the caches
+      for (int r = 0; r <= rounds; ++r)
+      {
+          if (r == 1)
+          {
+              generated = 0;
+              perf.start();
+          }
+
+          auto start = std::chrono::steady_clock::now();
+          ops = 0;
+          for (size_t i = 0; i < positions.size(); ++i)
+              ops += c.run(positions[i], legalMoves[i]);
+          std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+          if (r > 0 && ops > 0)
+              nsPerOp.push_back(elapsed.count() / ops);
+          if (r > 0)
+              totalOps += ops;
+      }
+
+      perf.stop();
+
+      if (nsPerOp.empty())
+          continue;
+
+      double mean = 0, var = 0;
+      for (double x : nsPerOp)
+          mean += x / nsPerOp.size();
+      for (double x : nsPerOp)
+          var += (x - mean) * (x - mean) / (nsPerOp.size() - 1);
+
+      std::stringstream line;
+      line << std::left << std::setw(28) << c.name << std::right << std::fixed << std::setprecision(1)
+           << std::setw(12) << mean << std::setw(10) << std::sqrt(var)
+           << std::setw(12) << *std::min_element(nsPerOp.begin(), nsPerOp.end())
+           << std::setw(12) << ops;
+      for (int e = 0; counters && e < PerfCounters::EVENT_NB; ++e)
+          if (perf.available(PerfCounters::Event(e)))
+              line << std::setw(10) << perf.value(PerfCounters::Event(e)) / totalOps;
+      sync_cout << line.str() << sync_endl;
+
+      // Figures per generated move, from the move generator component
+      if (generated)
+      {
+          genMoves = generated;
+          for (double x : nsPerOp)
+              genNs += x * totalOps / nsPerOp.size();
+          for (int e = 0; e < PerfCounters::EVENT_NB; ++e)
+              genEvents[e] = perf.value(PerfCounters::Event(e));
+          generated = 0;
+      }
+  }
+
+  if (genMoves)
+  {
+      std::stringstream line;
+      line << "\nPer generated move (" << genMoves / rounds << " per round): " << std::fixed
+           << std::setprecision(2) << genNs / genMoves << " ns";
+      for (int e = 0; counters && e < PerfCounters::EVENT_NB; ++e)
+          if (perf.available(PerfCounters::Event(e)))
+              line << ", " << genEvents[e] / genMoves << " " << eventNames[e];
+      sync_cout << line.str() << sync_endl;
+  }
+
+  // Keep the results alive
+  if (sink == 0x7FFFFFFFFFFFFFFF)
+      sync_cout << sync_endl;
+}
+
+namespace {
+
+  // A run of bench, as written on one line by "bench ... json"
+  struct BenchRun {
+    double nps;
+    double nodes;
+    vector<double> positionNps;
+  };
+
+  // number_after() reads the number of the first "key" at or after pos, and
+  // moves pos past it. pos becomes npos if there is no such key.
+  double number_after(const string& line, const string& key, size_t& pos) {
+
+    pos = line.find("\"" + key + "\":", pos);
+    if (pos == string::npos)
+        return 0;
+
+    pos += key.size() + 3;
+    return std::strtod(line.c_str() + pos, nullptr);
+  }
+
+  vector<BenchRun> read_runs(const string& fileName) {
+
+    vector<BenchRun> runs;
+    ifstream file(fileName);
+    string line;
+
+    while (getline(file, line))
+    {
+        size_t pos = 0, positions = line.find("\"positions\":");
+        if (line.empty() || line[0] != '{' || positions == string::npos)
+            continue;
+
+        BenchRun run;
+        run.nodes = number_after(line, "nodes", pos);
+        pos = 0;
+        run.nps = number_after(line, "nps", pos);
+
+        for (pos = positions; ; )
+        {
+            double nps = number_after(line, "nps", pos);
+            if (pos == string::npos)
+                break;
+            run.positionNps.push_back(nps);
+        }
+
+        runs.push_back(run);
+    }
+
+    return runs;
+  }
+
+  // Two-sided 95% quantile of Student's t distribution with df degrees of freedom
+  double t_quantile(double df) {
+
+    constexpr double T[] = { 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                             2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086 };
+    int i = int(df);
+    return i < 1 ? T[0] : i <= 20 ? T[i - 1] : 1.960 + 2.5 / df;
+  }
+
+  void mean_variance(const vector<double>& v, double& mean, double& var) {
+
+    mean = var = 0;
+    for (double x : v)
+        mean += x / v.size();
+    for (double x : v)
+        var += v.size() > 1 ? (x - mean) * (x - mean) / (v.size() - 1) : 0;
+  }
+
+} // namespace
+
+
+/// bench_compare() is called by "bench compare <old> <new>". Each file holds
+/// the runs of one engine, one per line as appended by "bench ... json". It
+/// compares the mean nps of the two engines, with a 95% confidence interval
+/// from Welch's t-test when both engines have at least two runs, and shows
+/// the nps change of every position. The node counts should be the same, or
+/// the engines do not search the same trees.
+///
+/// bench compare old.json new.json
+
+void bench_compare(istream& is) {
+
+  string oldFile, newFile;
+  if (!(is >> oldFile >> newFile))
+  {
+      cout << "Usage: bench compare <old.json> <new.json>" << endl;
+      return;
+  }
+
+  const vector<BenchRun> oldRuns = read_runs(oldFile), newRuns = read_runs(newFile);
+  if (oldRuns.empty() || newRuns.empty())
+  {
+      cout << "No bench runs in " << (oldRuns.empty() ? oldFile : newFile) << endl;
+      return;
+  }
+
+  vector<double> oldNps, newNps;
+  for (const BenchRun& r : oldRuns)
+      oldNps.push_back(r.nps);
+  for (const BenchRun& r : newRuns)
+      newNps.push_back(r.nps);
+
+  double oldMean, oldVar, newMean, newVar;
+  mean_variance(oldNps, oldMean, oldVar);
+  mean_variance(newNps, newMean, newVar);
+
+  const double no = oldNps.size(), nn = newNps.size();
+  const double delta = 100 * (newMean - oldMean) / oldMean;
+
+  cout << std::fixed << std::setprecision(0)
+       << "Runs            : " << no << " old, " << nn << " new"
+       << "\nOld nps         : " << oldMean << " (stddev " << std::sqrt(oldVar) << ")"
+       << "\nNew nps         : " << newMean << " (stddev " << std::sqrt(newVar) << ")"
+       << std::setprecision(2) << std::showpos
+       << "\nDelta           : " << delta << "%";
+
+  if (no >= 2 && nn >= 2)
+  {
+      double a = oldVar / no, b = newVar / nn;
+      double se = std::sqrt(a + b);
+      double df = a + b > 0 ? (a + b) * (a + b) / (a * a / (no - 1) + b * b / (nn - 1)) : 1;
+      double ci = 100 * t_quantile(df) * se / oldMean;
+
+      cout << std::noshowpos << " +/- " << ci << "% (95%), "
+           << (delta > ci ? "faster" : delta < -ci ? "slower" : "no significant change");
+  }
+  else
+      cout << std::noshowpos << " (run each engine at least twice for a confidence interval)";
+
+  bool sameNodes = true;
+  for (const BenchRun& r : oldRuns)
+      for (const BenchRun& n : newRuns)
+          sameNodes &= r.nodes == n.nodes;
+
+  cout << "\nNodes           : " << std::setprecision(0)
+       << (sameNodes ? "same in all runs" : "differ, the engines do not search the same trees") << endl;
+
+  // Per position changes, if all runs have the same positions
+  size_t positions = oldRuns[0].positionNps.size();
+  for (const auto* runs : { &oldRuns, &newRuns })
+      for (const BenchRun& r : *runs)
+          if (r.positionNps.size() != positions)
+              positions = 0;
+
+  if (positions)
+      cout << "\n" << std::setw(8) << "position" << std::setw(12) << "old nps"
+           << std::setw(12) << "new nps" << std::setw(10) << "delta" << endl;
+
+  for (size_t i = 0; i < positions; ++i)
+  {
+      double o = 0, n = 0;
+      for (const BenchRun& r : oldRuns)
+          o += r.positionNps[i] / no;
+      for (const BenchRun& r : newRuns)
+          n += r.positionNps[i] / nn;
+
+      cout << std::setw(8) << i + 1 << std::setprecision(0) << std::setw(12) << o << std::setw(12) << n
+           << std::setprecision(2) << std::showpos << std::setw(9) << (o > 0 ? 100 * (n - o) / o : 0.0)
+           << "%" << std::noshowpos << endl;
+  }
+
+  cout << std::defaultfloat;
+}
+
 } // namespace Stockfish
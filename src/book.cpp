@@ -0,0 +1,289 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2022 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#define USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "book.h"
+#include "misc.h"
+#include "movegen.h"
+#include "position.h"
+#include "search.h"
+#include "thread.h"
+#include "uci.h"
+
+namespace Stockfish {
+
+namespace {
+
+  // A book entry scores the move leading from the position with canonical
+  // key 'key' to the position whose canonical key has 'child' as upper half.
+  // The score is from the point of view of the side to move in the position.
+  struct BookEntry {
+    uint64_t key;
+    uint32_t child;
+    int16_t score;
+    uint16_t depth;
+  };
+
+  static_assert(sizeof(BookEntry) == 16, "Unexpected BookEntry size");
+
+  struct BookHeader {
+    char magic[8];
+    uint64_t entryCount;
+  };
+
+  constexpr char BookMagic[8] = { 'F', 'S', 'B', 'K', '0', '0', '0', '1' };
+
+  const BookEntry* entries = nullptr;
+  size_t entryCount = 0;
+  std::vector<BookEntry> buffer; // Used when the file can not be mapped
+  bool building = false;
+
+#ifdef USE_MMAP
+  void* mappedFile = nullptr;
+  size_t mappedSize = 0;
+#endif
+
+  bool operator<(const BookEntry& e, Key k) { return e.key < k; }
+
+  bool operator<(const BookEntry& a, const BookEntry& b) {
+    return a.key < b.key || (a.key == b.key && a.score > b.score);
+  }
+
+  void free_book() {
+
+#ifdef USE_MMAP
+    if (mappedFile)
+        munmap(mappedFile, mappedSize);
+    mappedFile = nullptr;
+#endif
+
+    buffer.clear();
+    entries = nullptr;
+    entryCount = 0;
+  }
+
+  // child_key() returns the upper half of the canonical key after a move
+  uint32_t child_key(Position& pos, Move m) {
+
+    StateInfo st;
+    pos.do_move(m, st);
+    uint32_t key = uint32_t(pos.canonical_key() >> 32);
+    pos.undo_move(m);
+    return key;
+  }
+
+} // namespace
+
+
+/// Book::init() loads a book file, mapping it if possible. An empty name or
+/// "<empty>" unloads the current book. Returns false if the file is invalid.
+
+bool Book::init(const std::string& fileName) {
+
+  free_book();
+
+  if (fileName.empty() || fileName == "<empty>")
+      return true;
+
+  BookHeader header;
+  std::ifstream file(fileName, std::ios::binary);
+  if (   !file.read(reinterpret_cast<char*>(&header), sizeof(header))
+      || std::memcmp(header.magic, BookMagic, sizeof(BookMagic)))
+      return false;
+
+  file.seekg(0, std::ios::end);
+  if (size_t(file.tellg()) != sizeof(header) + header.entryCount * sizeof(BookEntry))
+      return false;
+
+#ifdef USE_MMAP
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd != -1)
+  {
+      size_t size = sizeof(header) + header.entryCount * sizeof(BookEntry);
+      void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+      close(fd);
+      if (data != MAP_FAILED)
+      {
+          mappedFile = data;
+          mappedSize = size;
+          entries = reinterpret_cast<const BookEntry*>(static_cast<char*>(data) + sizeof(header));
+          entryCount = header.entryCount;
+          return true;
+      }
+  }
+#endif
+
+  buffer.resize(header.entryCount);
+  file.seekg(sizeof(header));
+  if (!file.read(reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(BookEntry)))
+  {
+      buffer.clear();
+      return false;
+  }
+
+  entries = buffer.data();
+  entryCount = buffer.size();
+  return true;
+}
+
+
+/// Book::probe() returns the best scored legal move of the position in the
+/// book, or MOVE_NONE if the position is not in the book.
+
+Move Book::probe(Position& pos, Value& score) {
+
+  if (!entryCount || building)
+      return MOVE_NONE;
+
+  const Key key = pos.canonical_key();
+  const BookEntry* first = std::lower_bound(entries, entries + entryCount, key);
+  const BookEntry* last = first;
+  while (last < entries + entryCount && last->key == key)
+      ++last;
+
+  if (first == last)
+      return MOVE_NONE;
+
+  // Entries of a position are sorted by decreasing score, so the first one
+  // that matches a legal move is the best.
+  std::vector<std::pair<uint32_t, Move>> children;
+  for (const auto& m : MoveList<LEGAL>(pos))
+      children.emplace_back(child_key(pos, m), m);
+
+  for (const BookEntry* e = first; e < last; ++e)
+      for (const auto& c : children)
+          if (c.first == e->child)
+          {
+              score = Value(e->score);
+              return c.second;
+          }
+
+  return MOVE_NONE;
+}
+
+
+/// Book::build() implements the "book build" command. It walks the opening
+/// tree from the current position breadth first, up to the given number of
+/// plies. Each new position is searched by the whole thread pool with
+/// MultiPV set to the book width, and its best moves are scored in the book
+/// and expanded further. Symmetric positions are only searched once.
+///
+/// Usage: book build <file> [plies] [width] [depth]
+
+void Book::build(Position& pos, std::istream& is) {
+
+  std::string fileName;
+  int plies = 3, width = 4, depth = 6;
+
+  if (!(is >> fileName))
+  {
+      sync_cout << "Usage: book build <file> [plies] [width] [depth]" << sync_endl;
+      return;
+  }
+
+  is >> plies >> width >> depth;
+  plies = std::max(plies, 1);
+  width = std::max(width, 1);
+  depth = std::max(depth, 1);
+
+  const std::string multiPV = std::to_string(int(Options["MultiPV"]));
+  Options["MultiPV"] = std::to_string(width);
+  building = true;
+
+  std::vector<BookEntry> book;
+  std::set<Key> seen;
+  std::deque<std::pair<std::string, int>> queue = { { pos.fen(), 0 } };
+  TimePoint elapsed = now();
+
+  while (!queue.empty())
+  {
+      std::string fen = queue.front().first;
+      int ply = queue.front().second;
+      queue.pop_front();
+
+      StateListPtr states(new std::deque<StateInfo>(1));
+      Position p;
+      p.set(pos.variant(), fen, pos.is_chess960(), &states->back(), Threads.main());
+
+      const Key key = p.canonical_key();
+      if (!seen.insert(key).second || !MoveList<LEGAL>(p).size())
+          continue;
+
+      Search::LimitsType limits;
+      limits.startTime = now();
+      limits.depth = depth;
+      {
+          SilentCout silent;
+          Threads.start_thinking(p, states, limits);
+          Threads.main()->wait_for_search_finished();
+      }
+
+      const Search::RootLines& rootLines = Threads.main()->rootLines;
+      for (size_t i = 0; i < std::min(size_t(width), rootLines.size()); ++i)
+      {
+          Move m = rootLines[i].move();
+          Value v = rootLines[i].score != -VALUE_INFINITE ? rootLines[i].score : rootLines[i].previousScore;
+          book.push_back({ key, child_key(p, m), int16_t(std::clamp(int(v), -32000, 32000)),
+                           uint16_t(depth) });
+
+          if (ply + 1 < plies)
+          {
+              StateInfo st;
+              p.do_move(m, st);
+              queue.emplace_back(p.fen(), ply + 1);
+              p.undo_move(m);
+          }
+      }
+  }
+
+  building = false;
+  Options["MultiPV"] = multiPV;
+
+  std::sort(book.begin(), book.end());
+
+  BookHeader header = {};
+  std::memcpy(header.magic, BookMagic, sizeof(BookMagic));
+  header.entryCount = book.size();
+
+  std::ofstream file(fileName, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(book.data()), book.size() * sizeof(BookEntry));
+
+  sync_cout << "info string " << (file ? "Wrote " : "Could not write ") << book.size()
+            << " book entries of " << seen.size() << " positions to " << fileName
+            << " in " << (now() - elapsed) / 1000 << "s" << sync_endl;
+}
+
+} // namespace Stockfish
@@ -0,0 +1,48 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2022 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BOOK_H_INCLUDED
+#define BOOK_H_INCLUDED
+
+#include <iosfwd>
+#include <string>
+
+#include "types.h"
+
+namespace Stockfish {
+
+class Position;
+
+/// Book namespace implements the opening book used by the "Book File" option.
+/// A book file is a header followed by entries sorted by the canonical key of
+/// a position (see Position::canonical_key()). Each entry scores one move of
+/// the position, identified by the canonical key of the position it leads to,
+/// so the entries of one position serve all its rotations and reflections.
+/// The file is memory-mapped when possible and used as is.
+
+namespace Book {
+
+bool init(const std::string& fileName);
+Move probe(Position& pos, Value& score);
+void build(Position& pos, std::istream& is);
+
+} // namespace Book
+
+} // namespace Stockfish
+
+#endif // #ifndef BOOK_H_INCLUDED
@@ -220,6 +220,12 @@ namespace {
   constexpr Value LazyThreshold2    =  Value(1102);
   constexpr Value SpaceThreshold    =  Value(11551);
 
+  // Urbino bonuses per palace and per tower still in hand
+  TUNABLE UrbinoPalaceInHand = 30;
+  TUNABLE UrbinoTowerInHand  = 175;
+
+  TUNE_TUNABLE(UrbinoPalaceInHand, UrbinoTowerInHand, Eval::clear_cache);
+
   // KingAttackWeights[PieceType] contains king attack weights by piece type
   constexpr int KingAttackWeights[PIECE_TYPE_NB] = { 0, 0, 81, 52, 44, 10, 40 };
 
@@ -433,8 +439,18 @@ Value Eval::evaluate(const Position& pos) {
 
   Value v;
 
-  // Urbino uses district-based scoring
+  // Urbino uses an Urbino network if one is loaded, else district-based
+  // scoring. The latter only depends on the buildings, so it is cached by
+  // building configuration.
   if (pos.urbino_gating()) {
+      if (Eval::useNNUE && pos.nnue_applicable())
+          return std::clamp(NNUE::evaluate(pos), VALUE_TB_LOSS_IN_MAX_PLY + 1, VALUE_TB_WIN_IN_MAX_PLY - 1);
+
+      Key key = pos.building_key();
+      CacheEntry* e = pos.this_thread()->evalCache[key];
+      if (e->key == key)
+          return pos.side_to_move() == WHITE ? e->value : -e->value;
+
       int white_score, black_score;
       pos.urbino_scores(white_score, black_score);
 
@@ -446,10 +462,12 @@ Value Eval::evaluate(const Position& pos) {
 
       // Add to scores (multiply by 100 to maintain centipawn scale)
       // Palace penalty removed - palaces rarely fully depleted in practice
-      int white_hand_bonus = 30 * white_palaces_in_hand + 175 * white_towers_in_hand;
-      int black_hand_bonus = 30 * black_palaces_in_hand + 175 * black_towers_in_hand;
+      int white_hand_bonus = UrbinoPalaceInHand * white_palaces_in_hand + UrbinoTowerInHand * white_towers_in_hand;
+      int black_hand_bonus = UrbinoPalaceInHand * black_palaces_in_hand + UrbinoTowerInHand * black_towers_in_hand;
 
       v = Value((white_score - black_score) * 100 + white_hand_bonus - black_hand_bonus);
+      e->key = key;
+      e->value = v;
       return pos.side_to_move() == WHITE ? v : -v;
   }
 
@@ -508,6 +526,17 @@ Value Eval::evaluate(const Position& pos) {
   return v;
 }
 
+/// Eval::clear_cache() empties the evaluation cache of every thread. It must
+/// be called when the variant or an evaluation parameter changes, because the
+/// cache is only indexed by the building configuration.
+
+void Eval::clear_cache() {
+
+  for (Thread* th : Threads)
+      th->evalCache = Cache();
+}
+
+
 /// trace() is like evaluate(), but instead of returning a value, it returns
 /// a string (suitable for outputting to stdout) that contains the detailed
 /// descriptions and values of each evaluation term. Useful for debugging.
@@ -22,6 +22,7 @@
 #include <string>
 #include <optional>
 
+#include "misc.h"
 #include "types.h"
 
 #include "variant.h"
@@ -35,6 +36,17 @@ namespace Eval {
   std::string trace(Position& pos);
   Value evaluate(const Position& pos);
 
+  // Per-thread cache of the Urbino evaluation, from white's point of view,
+  // indexed by Position::building_key().
+  struct CacheEntry {
+    Key key;
+    Value value;
+  };
+
+  typedef HashTable<CacheEntry, 16384> Cache;
+
+  void clear_cache();
+
   extern bool useNNUE;
   extern std::string eval_file_loaded;
 
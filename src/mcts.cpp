@@ -0,0 +1,558 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2022 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "evaluate.h"
+#include "mcts.h"
+#include "misc.h"
+#include "movegen.h"
+#include "position.h"
+#include "search.h"
+#include "thread.h"
+#include "timeman.h"
+#include "uci.h"
+
+namespace Stockfish {
+
+namespace MCTS {
+
+namespace {
+
+  // PUCT exploration constant, first play urgency reduction and the scale
+  // that maps evaluations (in Eval::evaluate() units) to expected results.
+  constexpr double Cpuct        = 1.5;
+  constexpr double FpuReduction = 0.2;
+  constexpr double EvalScale    = 400.0;
+
+  // Results are accumulated as fixed point numbers so that they can be
+  // updated with a plain atomic fetch_add.
+  constexpr double Resolution = double(1 << 16);
+
+  enum NodeState : uint8_t { UNEXPANDED, EXPANDING, EXPANDED, TERMINAL };
+
+  // Edge is what a node stores for each legal move. The child node is only
+  // allocated when the edge is first selected, so that the wide Urbino nodes
+  // cost 8 bytes per move instead of a full node.
+  struct Edge {
+    Move move;
+    std::atomic<uint32_t> child;
+  };
+
+  // Node statistics are from the point of view of the side that made the move
+  // leading to the node. Virtual loss counts the descents currently in flight
+  // through the node, which are scored as losses until they are backed up.
+  struct Node {
+
+    void init(Key k) {
+      visits = virtualLoss = 0;
+      valueSum = 0;
+      firstEdge = edgeCount = 0;
+      terminalValue = 0;
+      key = k;
+      state = UNEXPANDED;
+    }
+
+    double q() const { return visits ? double(valueSum) / Resolution / visits : 0.5; }
+
+    std::atomic<uint32_t> visits, virtualLoss;
+    std::atomic<int64_t> valueSum;
+    std::atomic<uint8_t> state;
+    uint32_t firstEdge, edgeCount;
+    float terminalValue;
+    Key key;
+  };
+
+  // Tree owns the node and edge pools. Index 0 of the node pool is never used
+  // so that a zero child index means "not allocated yet".
+  struct Tree {
+    std::unique_ptr<Node[]> nodes;
+    std::unique_ptr<Edge[]> edges;
+    uint32_t nodeCapacity = 0, edgeCapacity = 0;
+    std::atomic<uint32_t> nodeCount, edgeCount;
+    uint32_t root = 0;
+    bool restrictedRoot = false;
+    size_t sizeMB = 0;
+  };
+
+  Tree tree;
+
+
+  // reset() drops all the nodes of the tree
+
+  void reset() {
+    tree.nodeCount = 1;
+    tree.edgeCount = 0;
+    tree.root = 0;
+  }
+
+
+  // allocate() sizes the pools after the "MCTS Hash" option. A quarter of
+  // the memory goes to nodes and the rest to edges.
+
+  void allocate(size_t mb) {
+
+    size_t bytes = mb * 1024 * 1024;
+    size_t nodeCount = std::min(bytes / 4 / sizeof(Node), size_t(UINT32_MAX / 2));
+    size_t edgeCount = std::min(bytes * 3 / 4 / sizeof(Edge), size_t(UINT32_MAX / 2));
+
+    tree.nodes.reset(new Node[nodeCount]);
+    tree.edges.reset(new Edge[edgeCount]);
+    tree.nodeCapacity = uint32_t(nodeCount);
+    tree.edgeCapacity = uint32_t(edgeCount);
+    tree.sizeMB = mb;
+    reset();
+  }
+
+
+  // new_node() and new_edges() take entries from the pools. They return 0 and
+  // UINT32_MAX respectively when the pool is exhausted, in which case the
+  // search goes on without growing the tree.
+
+  uint32_t new_node(Key k) {
+
+    if (tree.nodeCount.load(std::memory_order_relaxed) >= tree.nodeCapacity)
+        return 0;
+
+    uint32_t idx = tree.nodeCount.fetch_add(1, std::memory_order_relaxed);
+    if (idx >= tree.nodeCapacity)
+        return 0;
+
+    tree.nodes[idx].init(k);
+    return idx;
+  }
+
+  uint32_t new_edges(size_t n) {
+
+    if (tree.edgeCount.load(std::memory_order_relaxed) + n > tree.edgeCapacity)
+        return UINT32_MAX;
+
+    uint32_t first = tree.edgeCount.fetch_add(uint32_t(n), std::memory_order_relaxed);
+    return first + n > tree.edgeCapacity ? UINT32_MAX : first;
+  }
+
+
+  // to_result() converts an evaluation of the side to move into the expected
+  // result for the side that moved into the position, to_value() goes back.
+
+  double to_result(Value v) {
+    return 1.0 - 1.0 / (1.0 + std::exp(-double(v) / EvalScale));
+  }
+
+  Value to_value(double q) {
+    q = std::clamp(q, 0.0001, 0.9999);
+    double v = -EvalScale * std::log(1.0 / q - 1.0);
+    return Value(std::clamp(int(v), int(VALUE_MATED_IN_MAX_PLY) + 1, int(VALUE_MATE_IN_MAX_PLY) - 1));
+  }
+
+  double evaluate(const Position& pos) {
+    return to_result(pos.checkers() ? VALUE_ZERO : Eval::evaluate(pos));
+  }
+
+
+  // find() looks for the node of the given position in the first plies below
+  // the old root, so that the subtree can be reused after a move pair.
+
+  uint32_t find(uint32_t idx, Key k, int depth) {
+
+    const Node& n = tree.nodes[idx];
+    if (n.key == k)
+        return idx;
+
+    if (!depth || n.state.load(std::memory_order_acquire) != EXPANDED)
+        return 0;
+
+    for (uint32_t i = 0; i < n.edgeCount; ++i)
+        if (uint32_t c = tree.edges[n.firstEdge + i].child.load(std::memory_order_acquire))
+            if (uint32_t found = find(c, k, depth - 1))
+                return found;
+
+    return 0;
+  }
+
+
+  // expand() generates the edges of a leaf. It is called by the thread that
+  // won the UNEXPANDED -> EXPANDING transition and returns the leaf result.
+  // Only the game ends that depend on the position alone are stored in the
+  // node as TERMINAL; the others are checked by playout() on every visit.
+
+  double expand(Thread* th, Position& pos, Node& node, int ply) {
+
+    Value result;
+    if (pos.is_immediate_game_end(result, ply))
+    {
+        node.terminalValue = float(to_result(result));
+        node.state.store(TERMINAL, std::memory_order_release);
+        return node.terminalValue;
+    }
+
+    std::vector<Move> moves;
+    if (&node == &tree.nodes[tree.root])
+        for (const auto& rl : th->rootLines)
+            moves.push_back(rl.move());
+    else
+        for (const auto& m : MoveList<LEGAL>(pos))
+            moves.push_back(m);
+
+    if (moves.empty())
+    {
+        result = pos.checkers() ? pos.checkmate_value(ply) : pos.stalemate_value(ply);
+        node.terminalValue = float(to_result(result));
+        node.state.store(TERMINAL, std::memory_order_release);
+        return node.terminalValue;
+    }
+
+    uint32_t first = new_edges(moves.size());
+    if (first == UINT32_MAX)
+    {
+        node.state.store(UNEXPANDED, std::memory_order_release);
+        return evaluate(pos);
+    }
+
+    for (size_t i = 0; i < moves.size(); ++i)
+    {
+        tree.edges[first + i].move = moves[i];
+        tree.edges[first + i].child.store(0, std::memory_order_relaxed);
+    }
+
+    node.firstEdge = first;
+    node.edgeCount = uint32_t(moves.size());
+    node.state.store(EXPANDED, std::memory_order_release);
+
+    return evaluate(pos);
+  }
+
+
+  // select() picks the edge maximizing the PUCT formula. Priors are uniform
+  // and in-flight descents count as losses (virtual loss).
+
+  Edge& select(const Node& node) {
+
+    double parentVisits = node.visits + node.virtualLoss;
+    double sqrtVisits = std::sqrt(std::max(parentVisits, 1.0));
+    double prior = 1.0 / node.edgeCount;
+    double fpu = std::max(0.0, (node.visits ? 1.0 - node.q() : 0.5) - FpuReduction);
+
+    Edge* best = &tree.edges[node.firstEdge];
+    double bestScore = -1.0;
+
+    for (uint32_t i = 0; i < node.edgeCount; ++i)
+    {
+        Edge& e = tree.edges[node.firstEdge + i];
+        uint32_t c = e.child.load(std::memory_order_acquire);
+        double q = fpu, n = 0;
+
+        if (c)
+        {
+            const Node& child = tree.nodes[c];
+            n = child.visits + child.virtualLoss;
+            if (n > 0)
+                q = double(child.valueSum) / Resolution / n;
+        }
+
+        double score = q + Cpuct * prior * sqrtVisits / (1 + n);
+        if (score > bestScore)
+            bestScore = score, best = &e;
+    }
+
+    return *best;
+  }
+
+
+  // playout() runs one descent from the root to a leaf, evaluates the leaf and
+  // backs up the result. It returns the ply of the leaf.
+
+  int playout(Thread* th, MainThread* mainThread, StateInfo* states) {
+
+    Position& pos = th->rootPos;
+    Node* path[MAX_PLY + 1];
+    Move moves[MAX_PLY + 1];
+    int ply = 0;
+    double value; // From the point of view of the side that moved into path[ply]
+
+    path[0] = &tree.nodes[tree.root];
+    path[0]->virtualLoss.fetch_add(1, std::memory_order_relaxed);
+
+    while (true)
+    {
+        Node& node = *path[ply];
+        uint8_t state = node.state.load(std::memory_order_acquire);
+
+        if (state == TERMINAL)
+        {
+            value = node.terminalValue;
+            break;
+        }
+
+        // Repetitions, the move rule and other optional game ends depend on
+        // the path to the node and on its ply, which change when the subtree
+        // is reused, so they are never cached in the node.
+        Value result;
+        if (ply && pos.is_optional_game_end(result, ply))
+        {
+            value = to_result(result);
+            break;
+        }
+
+        if (state != EXPANDED)
+        {
+            uint8_t expected = UNEXPANDED;
+            value = node.state.compare_exchange_strong(expected, EXPANDING) ? expand(th, pos, node, ply)
+                                                                            : evaluate(pos);
+            break;
+        }
+
+        if (ply >= MAX_PLY - 1)
+        {
+            value = evaluate(pos);
+            break;
+        }
+
+        if (mainThread)
+            mainThread->check_time();
+
+        Edge& e = select(node);
+        moves[ply] = e.move;
+        pos.do_move(e.move, states[ply]);
+
+        uint32_t c = e.child.load(std::memory_order_acquire);
+        if (!c)
+        {
+            uint32_t fresh = new_node(pos.key());
+            if (fresh && !e.child.compare_exchange_strong(c, fresh))
+                fresh = 0; // Another thread allocated the child first, c holds it
+            c = fresh ? fresh : c;
+        }
+
+        // Out of nodes: evaluate the position after the move without adding
+        // it to the tree, then turn the result to the point of view of path[ply].
+        if (!c)
+        {
+            value = 1.0 - evaluate(pos);
+            pos.undo_move(moves[ply]);
+            break;
+        }
+
+        path[++ply] = &tree.nodes[c];
+        path[ply]->virtualLoss.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    int leafPly = ply;
+
+    for (int i = ply; i >= 0; --i)
+    {
+        Node& n = *path[i];
+        n.valueSum.fetch_add(int64_t(value * Resolution), std::memory_order_relaxed);
+        n.visits.fetch_add(1, std::memory_order_relaxed);
+        n.virtualLoss.fetch_sub(1, std::memory_order_relaxed);
+        value = 1.0 - value;
+
+        if (i > 0)
+            pos.undo_move(moves[i - 1]);
+    }
+
+    return leafPly;
+  }
+
+
+  // update_root_lines() copies the statistics of the root edges into the
+  // thread's root lines, sorted by visits, so that UCI::pv(), get_best_thread()
+  // and the "bestmove" output work unchanged.
+
+  void update_root_lines(Thread* th, int selDepth) {
+
+    const Node& root = tree.nodes[tree.root];
+    if (root.state.load(std::memory_order_acquire) != EXPANDED)
+        return;
+
+    std::vector<std::pair<uint32_t, size_t>> order;
+
+    for (size_t i = 0; i < th->rootLines.size(); ++i)
+    {
+        Search::RootLine& rm = th->rootLines[i];
+        uint32_t visits = 0;
+
+        for (uint32_t j = 0; j < root.edgeCount; ++j)
+        {
+            const Edge& e = tree.edges[root.firstEdge + j];
+            if (e.move != rm.move())
+                continue;
+
+            uint32_t c = e.child.load(std::memory_order_acquire);
+            rm.previousScore = rm.score;
+            rm.selDepth = selDepth;
+            rm.pv.assign(1, rm.move());
+
+            if (c && (visits = tree.nodes[c].visits) > 0)
+            {
+                rm.score = to_value(tree.nodes[c].q());
+
+                // Follow the most visited children to build the PV
+                for (const Node* n = &tree.nodes[c]; rm.pv.size() < MAX_PLY && n->state.load(std::memory_order_acquire) == EXPANDED; )
+                {
+                    const Edge* bestEdge = nullptr;
+                    uint32_t bestVisits = 0;
+                    for (uint32_t k = 0; k < n->edgeCount; ++k)
+                    {
+                        const Edge& ce = tree.edges[n->firstEdge + k];
+                        uint32_t cc = ce.child.load(std::memory_order_acquire);
+                        if (cc && tree.nodes[cc].visits > bestVisits)
+                            bestVisits = tree.nodes[cc].visits, bestEdge = &ce;
+                    }
+                    if (!bestEdge)
+                        break;
+                    rm.pv.push_back(bestEdge->move);
+                    n = &tree.nodes[bestEdge->child];
+                }
+            }
+            else
+                rm.score = -VALUE_INFINITE;
+            break;
+        }
+        order.emplace_back(visits, i);
+    }
+
+    std::stable_sort(order.begin(), order.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    Search::RootLines sorted;
+    for (const auto& o : order)
+        sorted.push_back(std::move(th->rootLines[o.second]));
+    th->rootLines = std::move(sorted);
+  }
+
+} // namespace
+
+
+/// MCTS::enabled() returns true when the "SearchMode" option selects MCTS
+
+bool enabled() {
+  return Options["SearchMode"] == "MCTS";
+}
+
+
+/// MCTS::prepare() is called by the main thread before the helpers are woken
+/// up. It (re)allocates the pools and moves the root to the subtree of the new
+/// root position when it can be found within two plies of the old root.
+
+void prepare(const Position& rootPos) {
+
+  size_t mb = size_t(Options["MCTS Hash"]);
+  if (mb != tree.sizeMB)
+      allocate(mb);
+
+  bool restricted = !Search::Limits.searchmoves.empty() || !Search::Limits.banmoves.empty();
+  uint32_t root = 0;
+
+  // Reuse the old tree unless the root moves are filtered or the pools are
+  // mostly used up, in which case we rather start afresh.
+  if (   tree.root
+      && !restricted
+      && !tree.restrictedRoot
+      && tree.nodeCount < tree.nodeCapacity / 4 * 3
+      && tree.edgeCount < tree.edgeCapacity / 4 * 3)
+      root = find(tree.root, rootPos.key(), 2);
+
+  if (!root)
+  {
+      reset();
+      root = new_node(rootPos.key());
+  }
+  else
+      sync_cout << "info string MCTS reusing subtree of " << tree.nodes[root].visits
+                << " playouts" << sync_endl;
+
+  tree.root = root;
+  tree.restrictedRoot = restricted;
+}
+
+
+/// MCTS::search() is called by every thread in place of the iterative
+/// deepening loop. Threads run playouts on the shared tree until the search
+/// is stopped; the main thread also handles time and depth limits and sends
+/// the periodic PV info.
+
+void search(Thread* th) {
+
+  MainThread* mainThread = (th == Threads.main() ? Threads.main() : nullptr);
+  StateInfo states[MAX_PLY + 1];
+  uint64_t playouts = 0, plySum = 0;
+  int selDepth = 0;
+  TimePoint lastInfoTime = now();
+
+  if (!tree.root)
+      return;
+
+  while (!Threads.stop)
+  {
+      int ply = playout(th, mainThread, states);
+      ++playouts;
+      plySum += ply;
+      selDepth = std::max(selDepth, ply);
+
+      th->selDepth = selDepth;
+      th->rootDepth = th->completedDepth = std::max(1, int(plySum / playouts));
+
+      if (!mainThread || (playouts & 63))
+          continue;
+
+      // The depth limit applies to the deepest leaf reached so far
+      if (Search::Limits.depth && selDepth >= Search::Limits.depth)
+          Threads.stop = true;
+
+      // With time management, stop once the optimum time is spent
+      if (   Search::Limits.use_time_management()
+          && Time.elapsed() > Time.optimum())
+      {
+          if (mainThread->ponder)
+              mainThread->stopOnPonderhit = true;
+          else
+              Threads.stop = true;
+      }
+
+      if (now() - lastInfoTime >= 1000)
+      {
+          lastInfoTime = now();
+          update_root_lines(th, selDepth);
+          sync_cout << UCI::pv(th->rootPos, th->completedDepth, -VALUE_INFINITE, VALUE_INFINITE) << sync_endl;
+      }
+  }
+
+  update_root_lines(th, selDepth);
+
+  if (mainThread)
+      sync_cout << UCI::pv(th->rootPos, th->completedDepth, -VALUE_INFINITE, VALUE_INFINITE) << sync_endl;
+}
+
+
+/// MCTS::clear() forgets the tree, usually before a new game
+
+void clear() {
+
+  if (tree.nodes)
+      reset();
+}
+
+} // namespace MCTS
+
+} // namespace Stockfish
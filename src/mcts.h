@@ -0,0 +1,45 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2022 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MCTS_H_INCLUDED
+#define MCTS_H_INCLUDED
+
+#include "types.h"
+
+namespace Stockfish {
+
+class Position;
+class Thread;
+
+/// MCTS namespace implements the alternative "SearchMode = MCTS" search. All
+/// the threads share a single PUCT tree whose nodes and edges live in two
+/// preallocated pools. Parallel descents are spread over the tree with virtual
+/// loss, and the subtree of the new root position is kept between moves.
+
+namespace MCTS {
+
+bool enabled();
+void prepare(const Position& rootPos);
+void search(Thread* th);
+void clear();
+
+} // namespace MCTS
+
+} // namespace Stockfish
+
+#endif // #ifndef MCTS_H_INCLUDED
@@ -47,8 +47,14 @@ typedef bool(*fun3_t)(HANDLE, CONST GROUP_AFFINITY*, PGROUP_AFFINITY);
 #include <cstdlib>
 
 #if defined(__linux__) && !defined(__ANDROID__)
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sched.h>
 #include <stdlib.h>
+#include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #endif
 
 #if defined(__APPLE__) || defined(__ANDROID__) || defined(__OpenBSD__) || (defined(__GLIBCXX__) && !defined(_GLIBCXX_HAVE_ALIGNED_ALLOC) && !defined(_WIN32)) || defined(__e2k__)
@@ -596,6 +602,230 @@ void bindThisThread(size_t idx) {
 
 } // namespace WinProcGroup
 
+namespace Numa {
+
+#if defined(__linux__) && !defined(__ANDROID__)
+
+/// online_nodes() reads the online nodes and their CPUs from sysfs, once. An
+/// empty result means that the topology is unknown or has a single node.
+
+struct Node {
+  int id;
+  std::vector<int> cpus;
+};
+
+const std::vector<Node>& online_nodes() {
+
+  static const std::vector<Node> onlineNodes = [] {
+
+      std::vector<Node> nodes;
+
+      // Lists like "0-3,8-11"
+      auto parse = [](const string& list) {
+          std::vector<int> v;
+          std::stringstream ss(list);
+          string range;
+          while (std::getline(ss, range, ','))
+          {
+              size_t dash = range.find('-');
+              int first = std::atoi(range.c_str());
+              int last = dash == string::npos ? first : std::atoi(range.c_str() + dash + 1);
+              for (int i = first; i <= last; ++i)
+                  v.push_back(i);
+          }
+          return v;
+      };
+
+      std::ifstream online("/sys/devices/system/node/online");
+      string list;
+      if (!std::getline(online, list))
+          return nodes;
+
+      for (int node : parse(list))
+      {
+          std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+          if (std::getline(cpulist, list) && !list.empty())
+              nodes.push_back({ node, parse(list) });
+      }
+
+      if (nodes.size() < 2)
+          nodes.clear();
+
+      return nodes;
+  }();
+
+  return onlineNodes;
+}
+
+size_t nodes() {
+  return std::max(online_nodes().size(), size_t(1));
+}
+
+/// bind_this_thread() binds the current thread to the CPUs of node idx % nodes()
+
+void bind_this_thread(size_t idx) {
+
+  const auto& nodes = online_nodes();
+  if (nodes.empty())
+      return;
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : nodes[idx % nodes.size()].cpus)
+      if (cpu < CPU_SETSIZE)
+          CPU_SET(cpu, &set);
+
+  sched_setaffinity(0, sizeof(set), &set);
+}
+
+/// interleave() asks the kernel to spread the pages of a memory block, which
+/// must not have been touched yet, over all the nodes.
+
+void interleave(void* mem, size_t size) {
+
+#ifdef SYS_mbind
+  if (!mem || online_nodes().empty())
+      return;
+
+  // The node ids need not be contiguous, so set the bit of each online node
+  constexpr int MPOL_INTERLEAVE_MODE = 3;
+  unsigned long nodeMask = 0;
+  int maxNode = 0;
+  for (const Node& node : online_nodes())
+  {
+      if (node.id >= int(8 * sizeof(nodeMask)))
+          return;
+      nodeMask |= 1UL << node.id;
+      maxNode = std::max(maxNode, node.id);
+  }
+
+  // mbind() fails silently if the block is not page aligned
+  syscall(SYS_mbind, mem, size, MPOL_INTERLEAVE_MODE, &nodeMask, maxNode + 2, 0);
+#else
+  (void)mem; (void)size;
+#endif
+}
+
+#else
+
+size_t nodes() { return 1; }
+void bind_this_thread(size_t) {}
+void interleave(void*, size_t) {}
+
+#endif
+
+} // namespace Numa
+
+#if defined(__linux__) && !defined(__ANDROID__)
+
+/// PerfCounters::start() opens the events for every thread that exists now,
+/// and starts counting from zero. An event is dropped if it can not be opened
+/// for all threads, rather than reporting a partial count.
+
+void PerfCounters::start() {
+
+  constexpr uint32_t Type[EVENT_NB] = {
+      PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE };
+  constexpr uint64_t Config[EVENT_NB] = {
+      PERF_COUNT_HW_CPU_CYCLES,
+      PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+      PERF_COUNT_HW_CACHE_LL  | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+      PERF_COUNT_HW_BRANCH_MISSES };
+
+  close();
+
+  std::vector<pid_t> tids;
+  if (DIR* dir = opendir("/proc/self/task"))
+  {
+      while (dirent* entry = readdir(dir))
+          if (entry->d_name[0] != '.')
+              tids.push_back(pid_t(atoi(entry->d_name)));
+      closedir(dir);
+  }
+
+  for (int e = 0; e < EVENT_NB; ++e)
+  {
+      perf_event_attr attr = {};
+      attr.size = sizeof(attr);
+      attr.type = Type[e];
+      attr.config = Config[e];
+      attr.disabled = 1;
+      attr.exclude_kernel = 1; // Allowed with the default perf_event_paranoid
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      for (pid_t tid : tids)
+      {
+          int fd = int(syscall(SYS_perf_event_open, &attr, tid, -1, -1, 0));
+          if (fd == -1)
+          {
+              for (int f : fds[e])
+                  ::close(f);
+              fds[e].clear();
+              break;
+          }
+          fds[e].push_back(fd);
+      }
+  }
+
+  for (const auto& v : fds)
+      for (int fd : v)
+      {
+          ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+          ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+}
+
+void PerfCounters::stop() {
+
+  for (const auto& v : fds)
+      for (int fd : v)
+          ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+}
+
+/// PerfCounters::value() sums an event over the threads. When the kernel had
+/// to multiplex the events, the count is scaled up to the whole time enabled.
+
+double PerfCounters::value(Event e) const {
+
+  double sum = 0;
+  for (int fd : fds[e])
+  {
+      uint64_t data[3]; // Value, time enabled, time running
+      if (read(fd, data, sizeof(data)) == sizeof(data) && data[2])
+          sum += double(data[0]) * data[1] / data[2];
+  }
+  return sum;
+}
+
+void PerfCounters::close() {
+
+  for (auto& v : fds)
+  {
+      for (int fd : v)
+          ::close(fd);
+      v.clear();
+  }
+}
+
+#else
+
+void PerfCounters::start() {}
+void PerfCounters::stop() {}
+double PerfCounters::value(Event) const { return 0; }
+void PerfCounters::close() {}
+
+#endif
+
+bool PerfCounters::available() const {
+
+  for (const auto& v : fds)
+      if (!v.empty())
+          return true;
+  return false;
+}
+
 #ifdef _WIN32
 #include <direct.h>
 #define GETCWD _getcwd
@@ -21,6 +21,7 @@
 
 #include <cassert>
 #include <chrono>
+#include <iostream>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -66,6 +67,18 @@ std::ostream& operator<<(std::ostream&, SyncCout);
 #define sync_cout std::cout << IO_LOCK
 #define sync_endl std::endl << IO_UNLOCK
 
+/// SilentCout discards everything written to std::cout while it is in scope.
+/// Used by commands that run searches internally and only want their own
+/// summary on the console, not the info and bestmove lines of each search.
+
+struct SilentCout {
+  SilentCout() : buf(std::cout.rdbuf(nullptr)) {}
+  ~SilentCout() { std::cout.rdbuf(buf); }
+
+private:
+  std::streambuf* buf;
+};
+
 
 // align_ptr_up() : get the first aligned element of an array.
 // ptr must point to an array of size at least `sizeof(T) * N + alignment` bytes,
@@ -188,6 +201,45 @@ namespace WinProcGroup {
   void bindThisThread(size_t idx);
 }
 
+/// Numa namespace spreads threads and memory over the NUMA nodes of Linux
+/// machines. Threads are bound round-robin to the nodes, and memory can be
+/// interleaved over all of them. On single node machines and on other
+/// systems all of this does nothing.
+
+namespace Numa {
+  size_t nodes();
+  void bind_this_thread(size_t idx);
+  void interleave(void* mem, size_t size);
+}
+
+/// PerfCounters counts hardware events in all threads of the process with
+/// perf_event_open() on Linux, for the bench commands. Threads created after
+/// start() are not counted. An event that the kernel, the hardware or the
+/// permissions do not provide is simply not available, and on other systems
+/// no event is.
+
+class PerfCounters {
+
+public:
+  enum Event { CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES, EVENT_NB };
+
+  PerfCounters() = default;
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+  ~PerfCounters() { close(); }
+
+  void start();
+  void stop();
+  bool available() const;
+  bool available(Event e) const { return !fds[e].empty(); }
+  double value(Event e) const;
+
+private:
+  void close();
+
+  std::vector<int> fds[EVENT_NB];
+};
+
 namespace CommandLine {
   void init(int argc, char* argv[]);
 
@@ -843,7 +843,7 @@ ExtMove* generate<LEGAL>(const Position& pos, ExtMove* moveList) {
 
   while (cur != moveList) {
       if (!pos.legal(*cur) || pos.virtual_drop(*cur)) {
-          sync_cout << "DEBUG generate<LEGAL> removing illegal move: " << UCI::move(pos, *cur) << sync_endl;
+          // sync_cout << "DEBUG generate<LEGAL> removing illegal move: " << UCI::move(pos, *cur) << sync_endl;
           *cur = (--moveList)->move;
       } else
           ++cur;
@@ -38,6 +38,13 @@ namespace {
     QSEARCH_TT, QCAPTURE_INIT, QCAPTURE, QCHECK_INIT, QCHECK
   };
 
+  // Urbino move ordering bonuses for building a house, a palace or a tower,
+  // and per building adjacent to the new one
+  TUNABLE UrbinoBuildingBonus[] = { 1500, 1750, 2000 };
+  TUNABLE UrbinoAdjacencyBonus  = 750;
+
+  TUNE_TUNABLE(UrbinoBuildingBonus, UrbinoAdjacencyBonus);
+
   // partial_insertion_sort() sorts moves in descending order up to and including
   // a given limit. The order of moves smaller than the limit is left unspecified.
   void partial_insertion_sort(ExtMove* begin, ExtMove* end, int limit) {
@@ -132,24 +139,17 @@ void MovePicker::score() {
               Square buildingSq = gating_square(m);
 
               // Bonus for building type (towers > palaces > houses)
-              // Tuned values: shallow gradient (slope=250) with high intercept (1500)
-              int buildingBonus = 0;
-              if (buildingType == CUSTOM_PIECE_4)      // Tower
-                  buildingBonus = 2000;
-              else if (buildingType == CUSTOM_PIECE_3) // Palace
-                  buildingBonus = 1750;
-              else if (buildingType == CUSTOM_PIECE_2) // House
-                  buildingBonus = 1500;
+              int buildingBonus = buildingType >= CUSTOM_PIECE_2 && buildingType <= CUSTOM_PIECE_4
+                                ? int(UrbinoBuildingBonus[buildingType - CUSTOM_PIECE_2]) : 0;
 
               // Bonus for adjacency to existing buildings (potential for merging/scoring)
-              // Tuned value: 750 per adjacent building (dominant factor in move ordering)
               Bitboard allBuildings = pos.pieces(CUSTOM_PIECE_2) | pos.pieces(CUSTOM_PIECE_3) | pos.pieces(CUSTOM_PIECE_4);
               Bitboard neighbors = (shift<NORTH>(square_bb(buildingSq)) | shift<SOUTH>(square_bb(buildingSq)) |
                                    shift<EAST>(square_bb(buildingSq)) | shift<WEST>(square_bb(buildingSq))) & pos.board_bb();
               int adjacentCount = popcount(neighbors & allBuildings);
 
               // More adjacent buildings = more potential for scoring (bonus per adjacent building)
-              int adjacencyBonus = adjacentCount * 750;
+              int adjacencyBonus = adjacentCount * UrbinoAdjacencyBonus;
 
               m.value += buildingBonus + adjacencyBonus;
           }
@@ -208,6 +208,7 @@ top:
   case QCAPTURE_INIT:
       cur = endBadCaptures = moves;
       endMoves = generate<CAPTURES>(pos, cur);
+      STATS(generatedMoves += int(endMoves - cur));
       if (stage == CAPTURE_INIT && cur < endMoves)
           hasGeneratedMoves = true;
 
@@ -250,6 +251,7 @@ top:
       {
           cur = endBadCaptures;
           endMoves = generate<QUIETS>(pos, cur);
+          STATS(generatedMoves += int(endMoves - cur));
           if (cur < endMoves)
               hasGeneratedMoves = true;
 
@@ -286,6 +288,7 @@ top:
       {
           cur = moves;
           endMoves = generate<FORCEDPASS>(pos, cur);
+          STATS(generatedMoves += int(endMoves - cur));
       }
       ++stage;
       [[fallthrough]];
@@ -296,6 +299,7 @@ top:
   case EVASION_INIT:
       cur = moves;
       endMoves = generate<EVASIONS>(pos, cur);
+      STATS(generatedMoves += int(endMoves - cur));
 
       score<EVASIONS>();
       ++stage;
@@ -322,6 +326,7 @@ top:
   case QCHECK_INIT:
       cur = moves;
       endMoves = generate<QUIET_CHECKS>(pos, cur);
+      STATS(generatedMoves += int(endMoves - cur));
 
       ++stage;
       [[fallthrough]];
@@ -334,4 +339,28 @@ top:
   return MOVE_NONE; // Silence warning
 }
 
+
+/// MovePicker::stage_name() names a stage for the search statistics. A picker
+/// has already advanced past its TT stage when it returns the TT move, so the
+/// stage that follows a TT stage is named after the TT move.
+const char* MovePicker::stage_name(int st) {
+
+  switch (st) {
+  case CAPTURE_INIT:  return "main_tt";
+  case GOOD_CAPTURE:  return "good_capture";
+  case REFUTATION:    return "refutation";
+  case QUIET:         return "quiet";
+  case BAD_CAPTURE:   return "bad_capture";
+  case FORCED_PASS:   return "forced_pass";
+  case EVASION_INIT:  return "evasion_tt";
+  case EVASION:       return "evasion";
+  case PROBCUT_INIT:  return "probcut_tt";
+  case PROBCUT:       return "probcut";
+  case QCAPTURE_INIT: return "qsearch_tt";
+  case QCAPTURE:      return "qcapture";
+  case QCHECK:        return "qcheck";
+  default:            return "other";
+  }
+}
+
 } // namespace Stockfish
@@ -25,6 +25,7 @@
 
 #include "movegen.h"
 #include "position.h"
+#include "stats.h"
 #include "types.h"
 
 namespace Stockfish {
@@ -73,6 +74,14 @@ struct Stats : public std::array<Stats<T, D, Sizes...>, Size>
     entry* p = reinterpret_cast<entry*>(this);
     std::fill(p, p + sizeof(*this) / sizeof(entry), v);
   }
+
+  void scale(int num, int den) {
+
+    typedef StatsEntry<T, D> entry;
+    entry* p = reinterpret_cast<entry*>(this);
+    for (entry* e = p; e < p + sizeof(*this) / sizeof(entry); ++e)
+        *e = T(*e * num / den);
+  }
 };
 
 template <typename T, int D, int Size>
@@ -141,6 +150,9 @@ public:
                                            const Move*,
                                            int);
   Move next_move(bool skipQuiets = false);
+  int current_stage() const { return stage; }
+  static const char* stage_name(int st);
+  STATS(int generated_moves() const { return generatedMoves; })
 
 private:
   template<PickType T, typename Pred> Move select(Pred);
@@ -162,6 +174,7 @@ private:
   Value threshold;
   Depth depth;
   int ply;
+  STATS(int generatedMoves = 0;)
   ExtMove moves[MAX_MOVES];
 };
 
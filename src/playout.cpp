@@ -0,0 +1,499 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2022 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "movegen.h"
+#include "playout.h"
+#include "position.h"
+#include "variant.h"
+
+namespace Stockfish {
+
+namespace {
+
+  // random_square() returns a random square of a non-empty bitboard
+  Square random_square(Bitboard b, PRNG& rng) {
+
+    assert(b);
+
+    for (uint64_t n = mul_hi64(rng.rand<uint64_t>(), uint64_t(popcount(b))); n; --n)
+        b &= b - 1;
+
+    return lsb(b);
+  }
+
+  // Monuments are three buildings of the same color in a row (orthogonally),
+  // so they always lie inside a single district.
+  Bitboard in_a_row(Bitboard ends, Bitboard middle) {
+    return (ends & shift<NORTH>(middle) & shift<NORTH>(shift<NORTH>(ends)))
+         | (ends & shift<EAST >(middle) & shift<EAST >(shift<EAST >(ends)));
+  }
+
+} // namespace
+
+
+/// UrbinoPlayout::set() initializes the playout state from a position
+
+void UrbinoPlayout::set(const Position& pos) {
+
+  assert(pos.urbino_gating());
+
+  board = pos.board_bb();
+  architects = pos.pieces(CUSTOM_PIECE_1);
+
+  for (int t = HOUSE; t < BUILDING_NB; ++t)
+      byType[t] = pos.pieces(PieceType(CUSTOM_PIECE_2 + t));
+
+  for (Color c : { WHITE, BLACK })
+  {
+      ownArchitect[c] = pos.pieces(c, CUSTOM_PIECE_1);
+      byColor[c] = pos.pieces(c) & ~architects;
+      scores[c] = 0;
+      for (int t = HOUSE; t < BUILDING_NB; ++t)
+          hand[c][t] = pos.count_in_hand(c, PieceType(CUSTOM_PIECE_2 + t));
+  }
+
+  gamePly = pos.game_ply();
+  sideToMove = pos.side_to_move();
+  monuments = pos.variant()->urbinoMonuments;
+
+  const StateInfo* st = pos.state();
+  passes = 0;
+  if (is_pass(st->move))
+      passes = st->previous && is_pass(st->previous->move) ? 2 : 1;
+
+  // Flood fill the buildings into districts
+  districtCount = 0;
+  Bitboard todo = byColor[WHITE] | byColor[BLACK];
+
+  while (todo)
+  {
+      Bitboard mask = 0, frontier = square_bb(lsb(todo));
+      while (frontier)
+      {
+          mask |= frontier;
+          frontier = neighbors(frontier) & todo & ~mask;
+      }
+      todo &= ~mask;
+      districts[districtCount++] = mask;
+      add_district(mask, 1);
+  }
+
+#ifndef NDEBUG
+  int w, b;
+  pos.urbino_scores(w, b);
+  assert(w == scores[WHITE] && b == scores[BLACK]);
+#endif
+
+  update_legal_builds();
+}
+
+
+/// UrbinoPlayout::neighbors() returns the orthogonal neighbours of a set of squares
+
+Bitboard UrbinoPlayout::neighbors(Bitboard b) const {
+  return (shift<NORTH>(b) | shift<SOUTH>(b) | shift<EAST>(b) | shift<WEST>(b)) & board;
+}
+
+
+/// UrbinoPlayout::add_district() adds (sign = 1) or removes (sign = -1) the
+/// points of a district to/from the score of its owner. The rules are the ones
+/// of Position::urbino_scores(): a district only scores when both colors are
+/// present, ties are broken by monuments, then towers, then palaces.
+
+void UrbinoPlayout::add_district(Bitboard mask, int sign) {
+
+  if (!(mask & byColor[WHITE]) || !(mask & byColor[BLACK]))
+      return;
+
+  int value[COLOR_NB], towers[COLOR_NB], palaces[COLOR_NB], monument[COLOR_NB];
+
+  for (Color c : { WHITE, BLACK })
+  {
+      Bitboard h = mask & byColor[c] & byType[HOUSE];
+      Bitboard p = mask & byColor[c] & byType[PALACE];
+      Bitboard t = mask & byColor[c] & byType[TOWER];
+
+      towers[c] = popcount(t);
+      palaces[c] = popcount(p);
+      value[c] = popcount(h) + 2 * palaces[c] + 3 * towers[c];
+      monument[c] = 0;
+
+      if (monuments)
+      {
+          monument[c] = in_a_row(t, p) ? 3 : in_a_row(p, h) ? 2 : in_a_row(h, h) ? 1 : 0;
+          value[c] += monument[c] == 3 ? 8 : monument[c] == 2 ? 5 : monument[c] == 1 ? 3 : 0;
+      }
+  }
+
+  Color owner =  value[WHITE]    != value[BLACK]    ? (value[WHITE]    > value[BLACK]    ? WHITE : BLACK)
+               : monument[WHITE] != monument[BLACK] ? (monument[WHITE] > monument[BLACK] ? WHITE : BLACK)
+               : towers[WHITE]   != towers[BLACK]   ? (towers[WHITE]   > towers[BLACK]   ? WHITE : BLACK)
+               : palaces[WHITE]  != palaces[BLACK]  ? (palaces[WHITE]  > palaces[BLACK]  ? WHITE : BLACK)
+                                                    : COLOR_NB;
+  if (owner != COLOR_NB)
+      scores[owner] += sign * value[owner];
+}
+
+
+/// UrbinoPlayout::update_legal_builds() computes the squares where the side to
+/// move may build without breaking the one-block-per-color rule, for all the
+/// squares at once. A square is illegal if it touches two districts holding an
+/// enemy block, or a district holding one of our blocks without touching it.
+/// This is the bitboard form of Position::urbino_legal_build(). The palace and
+/// tower adjacency rules and the pieces in hand are folded into the result, so
+/// that only the architects' line of sight is left to check per move.
+
+void UrbinoPlayout::update_legal_builds() {
+
+  Color us = sideToMove, them = ~us;
+  Bitboard once = 0, twice = 0, bad = 0;
+
+  for (int i = 0; i < districtCount; ++i)
+  {
+      Bitboard n = neighbors(districts[i]);
+
+      if (districts[i] & byColor[them])
+      {
+          twice |= once & n;
+          once |= n;
+      }
+      if (Bitboard ours = districts[i] & byColor[us])
+          bad |= n & ~neighbors(ours);
+  }
+
+  Bitboard legal = board & ~(twice | bad);
+
+  allowed[HOUSE]  = hand[us][HOUSE]  ? legal : Bitboard(0);
+  allowed[PALACE] = hand[us][PALACE] ? legal & ~neighbors(byType[PALACE]) : Bitboard(0);
+  allowed[TOWER]  = hand[us][TOWER]  ? legal & ~neighbors(byType[TOWER])  : Bitboard(0);
+  allowed[BUILDING_NB] = allowed[HOUSE] | allowed[PALACE] | allowed[TOWER];
+}
+
+
+/// UrbinoPlayout::sample() returns a random legal move. An architect move (or
+/// no architect move) is chosen uniformly by rejection sampling, then the
+/// building and its square are chosen uniformly among those it allows. When
+/// the random tries fail, the moves are counted exactly and one is picked
+/// uniformly, and a pass is returned only if no building can be placed at all.
+
+Move UrbinoPlayout::sample(PRNG& rng) const {
+
+  constexpr PieceType Buildings[] = { CUSTOM_PIECE_2, CUSTOM_PIECE_3, CUSTOM_PIECE_4 };
+  constexpr int MaxTries = 16;
+
+  Color us = sideToMove;
+  Bitboard occupied = architects | byColor[WHITE] | byColor[BLACK];
+  Bitboard empty = board & ~occupied;
+
+  // Architect drops at the first two plies
+  if (gamePly < 2)
+      return make_drop(random_square(empty, rng), CUSTOM_PIECE_1, CUSTOM_PIECE_1);
+
+  Bitboard arch1 = square_bb(lsb(architects)), arch2 = square_bb(msb(architects));
+  Bitboard targets[BUILDING_NB];
+
+  // Picks the building and its square among the targets of one architect move
+  auto pick = [&](Square from, Square to, MoveType mt) {
+      int total = 0;
+      for (int t = HOUSE; t < BUILDING_NB; ++t)
+          total += popcount(targets[t]);
+
+      uint64_t n = mul_hi64(rng.rand<uint64_t>(), uint64_t(total));
+      for (int t = HOUSE; t < BUILDING_NB; ++t)
+      {
+          if (n < uint64_t(popcount(targets[t])))
+          {
+              Bitboard b = targets[t];
+              while (n--)
+                  b &= b - 1;
+              return mt == NORMAL ? make_gating<NORMAL>(from, to, Buildings[t], lsb(b))
+                                  : make_gating<SPECIAL>(from, to, Buildings[t], lsb(b));
+          }
+          n -= popcount(targets[t]);
+      }
+      assert(false);
+      return MOVE_NONE;
+  };
+
+  // Computes the build squares of each type for the given architect squares
+  auto compute = [&](Bitboard a1, Bitboard a2, Bitboard occ) {
+      Bitboard b =  attacks_bb<QUEEN>(lsb(a1), occ)
+                  & attacks_bb<QUEEN>(lsb(a2), occ)
+                  & allowed[BUILDING_NB] & ~occ;
+      for (int t = HOUSE; t < BUILDING_NB; ++t)
+          targets[t] = b & allowed[t];
+      return b;
+  };
+
+  // Build without moving an architect: the only option at ply 2 (besides the
+  // pass) and at ply 3 after a pass.
+  bool buildOnly = gamePly == 2 || (gamePly == 3 && !(byColor[WHITE] | byColor[BLACK]));
+  if (buildOnly)
+  {
+      compute(arch1, arch2, occupied);
+      int total = popcount(targets[HOUSE]) + popcount(targets[PALACE]) + popcount(targets[TOWER]);
+
+      // At ply 2 passing is one more option, played with our own architect
+      if (gamePly == 2 && (!total || mul_hi64(rng.rand<uint64_t>(), uint64_t(total + 1)) == uint64_t(total)))
+          return make<SPECIAL>(lsb(ownArchitect[us]), lsb(ownArchitect[us]));
+
+      if (!total)
+          return make<SPECIAL>(lsb(architects), lsb(architects));
+
+      return pick(SQ_A1, SQ_A1, SPECIAL);
+  }
+
+  // Option i < 2 * emptyCount moves architect (i & 1) to the (i / 2)-th empty
+  // square, the last option keeps the architects where they are.
+  int emptyCount = popcount(empty);
+  int optionCount = 2 * emptyCount + 1;
+
+  auto try_option = [&](int i, Square& from, Square& to) {
+      if (i == 2 * emptyCount)
+      {
+          from = to = SQ_A1;
+          return compute(arch1, arch2, occupied);
+      }
+      Bitboard e = empty;
+      for (int n = i / 2; n; --n)
+          e &= e - 1;
+      Bitboard fromBB = i & 1 ? arch2 : arch1;
+      Bitboard toBB = e & -e;
+      from = lsb(fromBB);
+      to = lsb(toBB);
+      Bitboard occ = (occupied ^ fromBB) | toBB;
+      return compute(i & 1 ? arch1 : toBB, i & 1 ? toBB : arch2, occ);
+  };
+
+  Square from, to;
+
+  for (int i = 0; i < MaxTries; ++i)
+      if (try_option(int(mul_hi64(rng.rand<uint64_t>(), uint64_t(optionCount))), from, to))
+          return from == to ? pick(from, to, SPECIAL) : pick(from, to, NORMAL);
+
+  // The random tries failed, so count the moves exactly by building square,
+  // which is cheap once few squares are left. When one architect moves, a
+  // square s can be built on if the other architect sees it, and the possible
+  // destinations are the empty squares seen from s, except those that would
+  // block the line of sight of the other architect.
+  struct Entry { Square from, s; Bitboard tos; };
+
+  Entry entries[2 * SQUARE_NB];
+  uint64_t weights[2 * SQUARE_NB];
+  int entryCount = 0;
+
+  auto types_at = [&](Square s) {
+      return int(bool(allowed[HOUSE] & s)) + bool(allowed[PALACE] & s) + bool(allowed[TOWER] & s);
+  };
+
+  compute(arch1, arch2, occupied);
+  uint64_t stayCount = popcount(targets[HOUSE]) + popcount(targets[PALACE]) + popcount(targets[TOWER]);
+  uint64_t total = stayCount;
+
+  for (Bitboard mover : { arch1, arch2 })
+  {
+      Square other = lsb(architects ^ mover);
+      Bitboard occ = occupied ^ mover;
+      Bitboard b = attacks_bb<QUEEN>(other, occ) & allowed[BUILDING_NB] & ~occ;
+
+      while (b)
+      {
+          Square s = pop_lsb(b);
+          Bitboard tos = attacks_bb<QUEEN>(s, occ) & empty & ~between_bb(other, s);
+          if (tos)
+          {
+              entries[entryCount] = { lsb(mover), s, tos };
+              total += weights[entryCount++] = uint64_t(popcount(tos)) * types_at(s);
+          }
+      }
+  }
+
+  if (!total)
+      return make<SPECIAL>(lsb(architects), lsb(architects));
+
+  uint64_t n = mul_hi64(rng.rand<uint64_t>(), total);
+  if (n < stayCount)
+      return pick(SQ_A1, SQ_A1, SPECIAL);
+
+  n -= stayCount;
+  int i = 0;
+  while (n >= weights[i])
+      n -= weights[i++];
+
+  // Split the index into the destination and the building type
+  const Entry& e = entries[i];
+  int typeCount = types_at(e.s);
+  Bitboard tos = e.tos;
+  for (uint64_t k = n / typeCount; k; --k)
+      tos &= tos - 1;
+
+  int k = int(n % typeCount);
+  for (int t = HOUSE; t < BUILDING_NB; ++t)
+      if ((allowed[t] & e.s) && !k--)
+          return make_gating<NORMAL>(e.from, lsb(tos), Buildings[t], e.s);
+
+  assert(false);
+  return MOVE_NONE;
+}
+
+
+/// UrbinoPlayout::do_move() plays a move returned by sample() (or any legal
+/// move in the move generator's encoding) and merges the districts touched
+/// by the new building.
+
+void UrbinoPlayout::do_move(Move m) {
+
+  if (type_of(m) == DROP)
+  {
+      architects |= to_sq(m);
+      ownArchitect[sideToMove] |= to_sq(m);
+      passes = 0;
+  }
+  else if (is_pass(m))
+      ++passes;
+  else
+  {
+      passes = 0;
+
+      if (type_of(m) == NORMAL)
+      {
+          Bitboard fromTo = square_bb(from_sq(m)) | square_bb(to_sq(m));
+          architects ^= fromTo;
+          ownArchitect[ownArchitect[WHITE] & from_sq(m) ? WHITE : BLACK] ^= fromTo;
+      }
+
+      Square s = gating_square(m);
+      int t = gating_type(m) - CUSTOM_PIECE_2;
+      Bitboard merged = square_bb(s);
+      Bitboard n = neighbors(merged);
+
+      // Take out the points of the districts around s before merging them
+      for (int i = 0; i < districtCount; )
+          if (districts[i] & n)
+          {
+              add_district(districts[i], -1);
+              merged |= districts[i];
+              districts[i] = districts[--districtCount];
+          }
+          else
+              ++i;
+
+      assert(hand[sideToMove][t] > 0);
+      --hand[sideToMove][t];
+      byColor[sideToMove] |= s;
+      byType[t] |= s;
+
+      districts[districtCount++] = merged;
+      add_district(merged, 1);
+  }
+
+  ++gamePly;
+  sideToMove = ~sideToMove;
+  update_legal_builds();
+}
+
+
+/// UrbinoPlayout::play() plays random moves until the game is over and
+/// returns the final score difference from white's point of view.
+
+int UrbinoPlayout::play(PRNG& rng) {
+
+  while (!game_over())
+      do_move(sample(rng));
+
+  return scores[WHITE] - scores[BLACK];
+}
+
+
+/// UrbinoPlayout::bench() is called by the "playouts" command. It runs random
+/// playouts from the given position on several threads and reports the speed.
+/// Arguments are the number of playouts per thread (default 100000) and the
+/// number of threads (default 1).
+
+void UrbinoPlayout::bench(const Position& pos, std::istream& is) {
+
+  int64_t count = 100000;
+  size_t threads = 1;
+
+  if (is >> count)
+      is >> threads;
+
+  if (!pos.urbino_gating())
+  {
+      sync_cout << "info string playouts are only supported in Urbino" << sync_endl;
+      return;
+  }
+
+  threads = std::max(threads, size_t(1));
+
+  UrbinoPlayout root;
+  root.set(pos);
+
+  if (root.game_over())
+  {
+      sync_cout << "info string game is over" << sync_endl;
+      return;
+  }
+
+  std::vector<std::thread> workers;
+  std::vector<int64_t> plies(threads), whiteWins(threads), blackWins(threads);
+  TimePoint elapsed = now();
+
+  for (size_t idx = 0; idx < threads; ++idx)
+      workers.emplace_back([&, idx]() {
+          // Count locally and write the shared slots once, as the slots of
+          // the threads share cache lines
+          PRNG rng(1070372 + 7 * idx);
+          int64_t n = 0, w = 0, b = 0;
+          for (int64_t i = 0; i < count; ++i)
+          {
+              UrbinoPlayout p = root;
+              int r = p.play(rng);
+              n += p.game_ply() - root.game_ply();
+              w += r > 0;
+              b += r < 0;
+          }
+          plies[idx] = n, whiteWins[idx] = w, blackWins[idx] = b;
+      });
+
+  for (std::thread& th : workers)
+      th.join();
+
+  elapsed = now() - elapsed + 1; // Ensure positivity to avoid a 'divide by zero'
+
+  int64_t total = count * int64_t(threads), moves = 0, w = 0, b = 0;
+  for (size_t idx = 0; idx < threads; ++idx)
+      moves += plies[idx], w += whiteWins[idx], b += blackWins[idx];
+
+  std::cerr << "\n==========================="
+            << "\nTotal time (ms)         : " << elapsed
+            << "\nPlayouts                : " << total
+            << "\nPlayouts/second         : " << 1000 * total / elapsed
+            << "\nPlayouts/second/thread  : " << 1000 * total / elapsed / int64_t(threads)
+            << "\nMoves/second            : " << 1000 * moves / elapsed
+            << "\nAverage game length     : " << double(moves) / total
+            << "\nWhite/Black/Draw        : " << w << "/" << b << "/" << total - w - b << std::endl;
+}
+
+} // namespace Stockfish
@@ -0,0 +1,78 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2022 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PLAYOUT_H_INCLUDED
+#define PLAYOUT_H_INCLUDED
+
+#include <iosfwd>
+
+#include "bitboard.h"
+#include "misc.h"
+#include "types.h"
+
+namespace Stockfish {
+
+class Position;
+
+/// UrbinoPlayout is a self-contained Urbino game state for random playouts.
+/// Unlike Position it has no StateInfo chain, no hash keys and no undo, and
+/// it is copied by value, so a playout is just a copy of the root followed by
+/// sample()/do_move() until the game is over. Districts are kept as plain
+/// bitboards and the legal build squares of the side to move are computed
+/// once per move for all squares at the same time. Moves use the same
+/// encoding as the move generator, so they can be played on a Position too.
+
+class UrbinoPlayout {
+
+public:
+  static constexpr int MaxDistricts = 48;
+
+  void set(const Position& pos);
+  Move sample(PRNG& rng) const;
+  void do_move(Move m);
+  int play(PRNG& rng);
+
+  bool game_over() const { return passes >= 2; }
+  Color side_to_move() const { return sideToMove; }
+  int game_ply() const { return gamePly; }
+  int score(Color c) const { return scores[c]; }
+
+  static void bench(const Position& pos, std::istream& is);
+
+private:
+  enum { HOUSE, PALACE, TOWER, BUILDING_NB };
+
+  Bitboard neighbors(Bitboard b) const;
+  void add_district(Bitboard mask, int sign);
+  void update_legal_builds();
+
+  Bitboard board, architects, ownArchitect[COLOR_NB];
+  Bitboard byColor[COLOR_NB], byType[BUILDING_NB];
+  Bitboard allowed[BUILDING_NB + 1];
+  Bitboard districts[MaxDistricts];
+  int districtCount;
+  int scores[COLOR_NB];
+  int hand[COLOR_NB][BUILDING_NB];
+  int gamePly, passes;
+  Color sideToMove;
+  bool monuments;
+};
+
+} // namespace Stockfish
+
+#endif // #ifndef PLAYOUT_H_INCLUDED
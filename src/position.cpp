@@ -691,6 +691,46 @@ Position& Position::set(const string& code, Color c, StateInfo* si) {
 }
 
 
+/// Position::set() is an overload to initialize the position object as a copy
+/// of another one, as done for the root position of every search thread. This
+/// is much cheaper than going through a FEN string, which would also redo the
+/// Urbino district bookkeeping. The root StateInfo is copied into si, while
+/// earlier states are shared with pos since they are read-only.
+
+Position& Position::set(const Position& pos, StateInfo* si, Thread* th) {
+
+  std::copy(std::begin(pos.board), std::end(pos.board), board);
+  std::copy(std::begin(pos.unpromotedBoard), std::end(pos.unpromotedBoard), unpromotedBoard);
+  std::copy(std::begin(pos.byTypeBB), std::end(pos.byTypeBB), byTypeBB);
+  std::copy(std::begin(pos.byColorBB), std::end(pos.byColorBB), byColorBB);
+  std::copy(std::begin(pos.pieceCount), std::end(pos.pieceCount), pieceCount);
+  std::copy(std::begin(pos.castlingRightsMask), std::end(pos.castlingRightsMask), castlingRightsMask);
+  std::copy(std::begin(pos.castlingRookSquare), std::end(pos.castlingRookSquare), castlingRookSquare);
+  std::copy(std::begin(pos.castlingPath), std::end(pos.castlingPath), castlingPath);
+  std::copy(&pos.pieceCountInHand[0][0], &pos.pieceCountInHand[0][0] + COLOR_NB * PIECE_TYPE_NB, &pieceCountInHand[0][0]);
+  gamePly = pos.gamePly;
+  sideToMove = pos.sideToMove;
+  psq = pos.psq;
+  var = pos.var;
+  tsumeMode = pos.tsumeMode;
+  chess960 = pos.chess960;
+  virtualPieces = pos.virtualPieces;
+  promotedPieces = pos.promotedPieces;
+  urbinoDistId = pos.urbinoDistId;
+  urbinoDistricts = pos.urbinoDistricts;
+  urbinoScoreW = pos.urbinoScoreW;
+  urbinoScoreB = pos.urbinoScoreB;
+
+  *si = *pos.st;
+  st = si;
+  thisThread = th;
+
+  assert(pos_is_ok());
+
+  return *this;
+}
+
+
 /// Position::fen() returns a FEN representation of the position. In case of
 /// Chess960 the Shredder-FEN notation is used. This is mainly a debugging function.
 
@@ -1836,15 +1876,22 @@ void Position::do_move(Move m, StateInfo& newSt, bool givesCheck) {
   }
   else if (type_of(m) != CASTLING)
   {
-      if (Eval::useNNUE)
+      // For Urbino building-only moves, there's no piece to move
+      if (urbino_gating() && type_of(m) == SPECIAL && from == to)
       {
-          dp.piece[0] = pc;
-          dp.from[0] = from;
-          dp.to[0] = to;
+          dp.dirty_num = 0;
+          dp.piece[0] = NO_PIECE;
       }
-      // For Urbino building-only moves, there's no piece to move
-      if (!(urbino_gating() && type_of(m) == SPECIAL && from == to))
+      else
+      {
+          if (Eval::useNNUE)
+          {
+              dp.piece[0] = pc;
+              dp.from[0] = from;
+              dp.to[0] = to;
+          }
           move_piece(from, to);
+      }
   }
 
   // If the moving piece is a pawn do some special extra work
@@ -2435,7 +2482,7 @@ void Position::do_null_move(StateInfo& newSt) {
       st->key ^= Zobrist::enpassant[file_of(pop_lsb(st->epSquares))];
 
   st->key ^= Zobrist::side;
-  prefetch(TT.first_entry(key()));
+  prefetch(thisThread->pool.tt.first_entry(key()));
 
   ++st->rule50;
   st->pliesFromNull = 0;
@@ -2500,6 +2547,65 @@ Key Position::key_after(Move m) const {
 }
 
 
+/// Position::canonical_key() returns the smallest hash key of the position
+/// over the symmetries of the board: the 8 of the dihedral group D4 on square
+/// boards, else the 4 mirrors. Positions that only differ by a rotation or a
+/// reflection thus share it. Only the pieces on the board are mapped, so it
+/// is meant for variants without castling, en passant or walls, like Urbino.
+
+Key Position::canonical_key() const {
+
+  const int transforms = max_file() == File(max_rank()) ? 8 : 4;
+  Key boardKey = 0;
+
+  for (Bitboard b = pieces(); b; )
+  {
+      Square s = pop_lsb(b);
+      boardKey ^= Zobrist::psq[piece_on(s)][s];
+  }
+
+  Key best = st->key;
+
+  for (int t = 1; t < transforms; ++t)
+  {
+      Key k = st->key ^ boardKey;
+
+      for (Bitboard b = pieces(); b; )
+      {
+          Square s = pop_lsb(b);
+          int f = (t & 1) ? max_file() - file_of(s) : file_of(s);
+          int r = (t & 2) ? max_rank() - rank_of(s) : rank_of(s);
+          if (t & 4)
+              std::swap(f, r);
+          k ^= Zobrist::psq[piece_on(s)][make_square(File(f), Rank(r))];
+      }
+
+      best = std::min(best, k);
+  }
+
+  return best;
+}
+
+
+/// Position::building_key() returns the hash key of the Urbino buildings: the
+/// position key without the architects on the board and the side to move.
+/// The buildings in hand follow from the ones on the board, so positions
+/// with the same key have the same district scores and hand bonuses.
+
+Key Position::building_key() const {
+
+  Key k = st->key ^ (sideToMove == BLACK ? Zobrist::side : 0);
+
+  for (Bitboard b = pieces(CUSTOM_PIECE_1); b; )
+  {
+      Square s = pop_lsb(b);
+      k ^= Zobrist::psq[piece_on(s)][s];
+  }
+
+  return k;
+}
+
+
 Value Position::blast_see(Move m) const {
   assert(is_ok(m));
 
@@ -3696,7 +3802,6 @@ void Position::verify_urbino_consistency() const {
 }
 #endif
 
-#ifndef NDEBUG
 bool Position::urbino_legal_build_slow(Color us, Square s) const {
     // 0) Only relevant in Urbino
     if (!urbino_gating()) return true;
@@ -3769,7 +3874,103 @@ bool Position::urbino_legal_build_slow(Color us, Square s) const {
     // that s connects to, we'd have ≥2 our-blocks in the new district.
     return ( (oursInMerged & ~connectedViaS) == 0 );
 }
-#endif
+
+/// Position::urbino_verify() checks the incrementally updated Urbino state
+/// against a recomputation from scratch, also in release builds: districts,
+/// tallies, scores and exclusion masks against a copy set up from our FEN,
+/// the scores against the flood fill of urbino_scores(), the fast legal
+/// build test (cached and uncached) against urbino_legal_build_slow() on
+/// every empty square, and the legal moves of both positions. It returns a
+/// description of the first difference, or an empty string.
+
+std::string Position::urbino_verify() const {
+
+  if (!urbino_gating())
+      return "";
+
+  std::stringstream ss;
+  StateInfo si;
+  Position p;
+  p.set(var, fen(), is_chess960(), &si, thisThread);
+
+  int scoreW, scoreB;
+  p.urbino_scores(scoreW, scoreB);
+
+  if (p.urbinoScoreW != urbinoScoreW || p.urbinoScoreB != urbinoScoreB)
+      ss << "score " << urbinoScoreW << "-" << urbinoScoreB
+         << ", from scratch " << p.urbinoScoreW << "-" << p.urbinoScoreB;
+
+  else if (scoreW != urbinoScoreW || scoreB != urbinoScoreB)
+      ss << "score " << urbinoScoreW << "-" << urbinoScoreB
+         << ", by flood fill " << scoreW << "-" << scoreB;
+
+  else if (   p.urbino_excluded_palaces() != urbino_excluded_palaces()
+           || p.urbino_excluded_towers() != urbino_excluded_towers())
+      ss << "exclusion masks differ from scratch";
+
+  if (!ss.str().empty())
+      return ss.str();
+
+  // The district ids differ after merges, so compare the district of each
+  // building square with the district of the same square from scratch.
+  const Bitboard buildings = pieces(CUSTOM_PIECE_2) | pieces(CUSTOM_PIECE_3) | pieces(CUSTOM_PIECE_4);
+  for (Bitboard b = board_bb(); b; )
+  {
+      Square s = pop_lsb(b);
+      int id = urbinoDistId[s];
+
+      if ((id >= 0) != bool(buildings & s) || id >= int(urbinoDistricts.size()))
+          return "district id " + std::to_string(id) + " on " + UCI::square(*this, s);
+
+      if (id < 0)
+          continue;
+
+      const UrbinoDistrict& d = urbinoDistricts[id];
+      const UrbinoDistrict& r = p.urbinoDistricts[p.urbinoDistId[s]];
+
+      if (!d.alive || d.mask != r.mask)
+          return "district mask on " + UCI::square(*this, s);
+
+      if (   d.colorMask[WHITE] != r.colorMask[WHITE] || d.colorMask[BLACK] != r.colorMask[BLACK]
+          || d.hasBlock[WHITE] != r.hasBlock[WHITE] || d.hasBlock[BLACK] != r.hasBlock[BLACK])
+          return "district blocks on " + UCI::square(*this, s);
+
+      if (std::memcmp(&d.t, &r.t, sizeof(UrbinoDistTally)))
+          return "district tally on " + UCI::square(*this, s);
+  }
+
+  for (Bitboard b = board_bb() & ~pieces(); b; )
+  {
+      Square s = pop_lsb(b);
+      for (Color c : { WHITE, BLACK })
+      {
+          bool fast = urbino_legal_build(c, s), fresh = p.urbino_legal_build(c, s);
+          bool slow = urbino_legal_build_slow(c, s);
+          if (fast != slow || fresh != slow)
+          {
+              ss << "legal build of " << (c == WHITE ? "white" : "black") << " on " << UCI::square(*this, s)
+                 << ": " << fast << " (uncached " << fresh << "), from scratch " << slow;
+              return ss.str();
+          }
+      }
+  }
+
+  // Consecutive passes end the game, which the FEN does not record
+  if (is_immediate_game_end())
+      return "";
+
+  std::vector<Move> moves, fresh;
+  for (const auto& m : MoveList<LEGAL>(*this))
+      moves.push_back(m);
+  for (const auto& m : MoveList<LEGAL>(p))
+      fresh.push_back(m);
+  std::sort(moves.begin(), moves.end());
+  std::sort(fresh.begin(), fresh.end());
+  if (moves != fresh)
+      ss << moves.size() << " legal moves, from scratch " << fresh.size();
+
+  return ss.str();
+}
 
 bool Position::urbino_legal_build(Color us, Square s) const {
     Bitboard sq_bb = square_bb(s);
@@ -3777,8 +3978,10 @@ bool Position::urbino_legal_build(Color us, Square s) const {
     // Check if we've already computed this square
     if ((st->urbinoLegalBuildCache[us] | st->urbinoIllegalBuildCache[us]) & sq_bb) {
         // Already cached
+        STATS(if (thisThread) thisThread->stats.legal_build(true));
         return st->urbinoLegalBuildCache[us] & sq_bb;
     }
+    STATS(if (thisThread) thisThread->stats.legal_build(false));
 
     // Not cached - compute for this square only
     int adj[4], k=0; // dedup district ids around s
@@ -4048,6 +4251,7 @@ void Position::urbino_update_blocks(Square s, Color c, PieceType pt, UrbinoUndo&
         newD_ptr->t = {};
         urbino_add_piece(newD_ptr->t, c, pt);
     }
+    STATS(if (thisThread) thisThread->stats.merge(k, popcount(newD_ptr->mask)));
     if (variant()->urbinoMonuments) {
         if (c == WHITE) {
             if (pt == CUSTOM_PIECE_2) {
@@ -150,6 +150,7 @@ public:
   // FEN string input/output
   Position& set(const Variant* v, const std::string& fenStr, bool isChess960, StateInfo* si, Thread* th, bool sfen = false);
   Position& set(const std::string& code, Color c, StateInfo* si);
+  Position& set(const Position& pos, StateInfo* si, Thread* th);
   std::string fen(bool sfen = false, bool showPromoted = false, int countStarted = 0, std::string holdings = "-", Bitboard fogArea = 0) const;
 
   // Variant rule properties
@@ -229,18 +230,18 @@ public:
   bool urbino_gating() const;
   Bitboard urbino_excluded_palaces() const;
   Bitboard urbino_excluded_towers() const;
+  int urbino_score(Color c) const;
   void urbino_scores(int& white_score, int& black_score, bool debug = false) const;
 #ifndef NDEBUG
   void verify_urbino_consistency() const;
 #endif
+  std::string urbino_verify() const;
   void add_piece(UrbinoDistTally& t, Color c, PieceType pt);
   void urbino_update_blocks(Square s, Color c, PieceType pt, UrbinoUndo& u);
   void undo_move_urbino();
   Bitboard neighbors4_bb(Bitboard bb) const;
   void urbino_rebuild_all();
-#ifndef NDEBUG
   bool urbino_legal_build_slow(Color us, Square s) const;
-#endif
   bool urbino_legal_build(Color us, Square s) const;
   void urbino_add_piece(UrbinoDistTally& t, Color c, PieceType pt);
   void urbino_sub_score(const UrbinoDistTally& t, int& SW, int& SB);
@@ -368,6 +369,8 @@ public:
   // Accessing hash keys
   Key key() const;
   Key key_after(Move m) const;
+  Key canonical_key() const;
+  Key building_key() const;
   Key material_key(EndgameEval e = EG_EVAL_CHESS) const;
   Key pawn_key() const;
 
@@ -948,6 +951,10 @@ inline Bitboard Position::urbino_excluded_towers() const {
   return st->urbinoExcludedTowers;
 }
 
+inline int Position::urbino_score(Color c) const {
+  return c == WHITE ? urbinoScoreW : urbinoScoreB;
+}
+
 inline void Position::urbino_add_piece(UrbinoDistTally& t, Color c, PieceType pt){
     int* p = nullptr;
     if (c==WHITE) p = (pt==CUSTOM_PIECE_2)? &t.wH : (pt==CUSTOM_PIECE_3)? &t.wP : &t.wT;
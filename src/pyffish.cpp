@@ -4,7 +4,11 @@
 */
 
 #include <Python.h>
+#include <algorithm>
+#include <atomic>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #include "misc.h"
 #include "types.h"
@@ -400,6 +404,361 @@ extern "C" PyObject* pyffish_getFogFEN(PyObject* self, PyObject *args) {
     return Py_BuildValue("s", pos.fen(sfen, showPromoted, countStarted, "-", pos.fog_area()).c_str());
 }
 
+// Batches of (fen, move list) items are processed by native worker threads,
+// one per thread of the pool as set by the Threads option, with the GIL
+// released. The workers are started for each call and borrow the Thread
+// objects of the pool, whose own threads stay idle. The variant is set up
+// before the GIL is released, so other pyffish calls with another variant
+// must not run at the same time.
+struct BatchItem {
+    std::string fen;
+    std::vector<std::string> moves;
+};
+
+static bool parse_batch(PyObject* itemList, std::vector<BatchItem>& items) {
+    int numItems = PyList_Size(itemList);
+    items.resize(numItems);
+    for (int i = 0; i < numItems; i++)
+    {
+        PyObject* item = PySequence_Fast(PyList_GetItem(itemList, i), "batch items must be (fen, move list) pairs");
+        if (!item)
+            return false;
+        PyObject* moveList = PySequence_Size(item) == 2 ? PySequence_Fast(PySequence_Fast_GET_ITEM(item, 1), "move list must be a sequence") : NULL;
+        const char* fen = moveList ? PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(item, 0)) : NULL;
+        if (!fen)
+        {
+            if (!PyErr_Occurred())
+                PyErr_SetString(PyExc_TypeError, "batch items must be (fen, move list) pairs");
+            Py_XDECREF(moveList);
+            Py_DECREF(item);
+            return false;
+        }
+        items[i].fen = fen;
+        for (int j = 0; j < PySequence_Fast_GET_SIZE(moveList); j++)
+        {
+            const char* move = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(moveList, j));
+            if (!move)
+            {
+                Py_DECREF(moveList);
+                Py_DECREF(item);
+                return false;
+            }
+            items[i].moves.emplace_back(move);
+        }
+        Py_DECREF(moveList);
+        Py_DECREF(item);
+    }
+    return true;
+}
+
+// Sets up the position of each item and calls visit(pos, i) on it, with one
+// std::thread per thread of the pool. Returns false with a ValueError for an
+// unknown variant or for the first item that has an invalid move.
+template<typename Visit>
+static bool run_batch(const char* variant, const std::vector<BatchItem>& items, bool chess960, Visit visit) {
+    auto it = variants.find(std::string(variant));
+    if (it == variants.end())
+    {
+        PyErr_SetString(PyExc_ValueError, (std::string("No such variant '") + variant + "'").c_str());
+        return false;
+    }
+
+    const Variant* v = it->second;
+    std::vector<std::string> errors(items.size());
+    std::atomic<size_t> next(0);
+
+    UCI::init_variant(v);
+
+    Py_BEGIN_ALLOW_THREADS
+    std::vector<std::thread> workers;
+    for (size_t idx = 0; idx < std::min(Threads.size(), items.size()); ++idx)
+        workers.emplace_back([&, idx]() {
+            Thread* th = Threads[idx];
+            for (size_t i; (i = next++) < items.size(); )
+            {
+                StateListPtr states(new std::deque<StateInfo>(1));
+                Position pos;
+                const BatchItem& item = items[i];
+                pos.set(v, item.fen == "startpos" ? v->startFen : item.fen, chess960, &states->back(), th);
+
+                bool valid = true;
+                for (std::string moveStr : item.moves)
+                {
+                    Move m = UCI::to_move(pos, moveStr);
+                    if (m == MOVE_NONE)
+                    {
+                        errors[i] = "Invalid move '" + moveStr + "' in item " + std::to_string(i);
+                        valid = false;
+                        break;
+                    }
+                    states->emplace_back();
+                    pos.do_move(m, states->back());
+                }
+                if (valid)
+                    visit(pos, i);
+            }
+        });
+    for (std::thread& w : workers)
+        w.join();
+    Py_END_ALLOW_THREADS
+
+    for (const std::string& error : errors)
+        if (!error.empty())
+        {
+            PyErr_SetString(PyExc_ValueError, error.c_str());
+            return false;
+        }
+    return true;
+}
+
+// INPUT variant, list of (fen, move list)
+extern "C" PyObject* pyffish_legalMovesBatch(PyObject* self, PyObject *args) {
+    PyObject *itemList;
+    const char *variant;
+    int chess960 = false;
+    if (!PyArg_ParseTuple(args, "sO!|p", &variant, &PyList_Type, &itemList, &chess960)) {
+        return NULL;
+    }
+
+    std::vector<BatchItem> items;
+    if (!parse_batch(itemList, items))
+        return NULL;
+
+    std::vector<std::vector<std::string>> legal(items.size());
+    if (!run_batch(variant, items, chess960,
+                   [&](const Position& pos, size_t i) {
+                       for (const auto& m : MoveList<LEGAL>(pos))
+                           legal[i].push_back(UCI::move(pos, m));
+                   }))
+        return NULL;
+
+    PyObject* Result = PyList_New(items.size());
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        PyObject* legalMoves = PyList_New(legal[i].size());
+        for (size_t j = 0; j < legal[i].size(); j++)
+            PyList_SET_ITEM(legalMoves, j, Py_BuildValue("s", legal[i][j].c_str()));
+        PyList_SET_ITEM(Result, i, legalMoves);
+    }
+    return Result;
+}
+
+// INPUT variant, list of (fen, move list)
+// The result of a position is None while the game goes on
+extern "C" PyObject* pyffish_gameResultBatch(PyObject* self, PyObject *args) {
+    PyObject *itemList;
+    const char *variant;
+    int chess960 = false;
+    if (!PyArg_ParseTuple(args, "sO!|p", &variant, &PyList_Type, &itemList, &chess960)) {
+        return NULL;
+    }
+
+    std::vector<BatchItem> items;
+    if (!parse_batch(itemList, items))
+        return NULL;
+
+    std::vector<Value> results(items.size(), VALUE_NONE);
+    if (!run_batch(variant, items, chess960,
+                   [&](const Position& pos, size_t i) {
+                       Value result;
+                       if (pos.is_immediate_game_end(result))
+                           results[i] = result;
+                       else if (!MoveList<LEGAL>(pos).size())
+                           results[i] = pos.checkers() ? pos.checkmate_value() : pos.stalemate_value();
+                   }))
+        return NULL;
+
+    PyObject* Result = PyList_New(items.size());
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        if (results[i] == VALUE_NONE)
+        {
+            Py_INCREF(Py_None);
+            PyList_SET_ITEM(Result, i, Py_None);
+        }
+        else
+            PyList_SET_ITEM(Result, i, Py_BuildValue("i", results[i]));
+    }
+    return Result;
+}
+
+// Board keeps a live position and its states, so that playing through a game
+// costs O(1) per move instead of replaying the move list on every call
+struct BoardState {
+    const Variant* v;
+    StateListPtr states;
+    Position pos;
+    std::vector<Move> moveStack;
+};
+
+typedef struct {
+    PyObject_HEAD
+    BoardState* board;
+} PyBoard;
+
+static bool board_push(BoardState* b, std::string moveStr) {
+    Move m = UCI::to_move(b->pos, moveStr);
+    if (m == MOVE_NONE)
+    {
+        PyErr_SetString(PyExc_ValueError, (std::string("Invalid move '") + moveStr + "'").c_str());
+        return false;
+    }
+    b->states->emplace_back();
+    b->pos.do_move(m, b->states->back());
+    b->moveStack.push_back(m);
+    return true;
+}
+
+// Returns the state of an initialized board, else sets RuntimeError, e.g. for
+// Board.__new__(Board) or a subclass that has not called __init__ yet
+static BoardState* board_state(PyBoard* self) {
+    if (!self->board)
+        PyErr_SetString(PyExc_RuntimeError, "Board is not initialized");
+    return self->board;
+}
+
+static void Board_dealloc(PyBoard* self) {
+    delete self->board;
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+// INPUT variant, fen, move list
+static int Board_init(PyBoard* self, PyObject *args, PyObject *kwds) {
+    static const char* kwlist[] = {"variant", "fen", "movelist", "chess960", NULL};
+    PyObject *moveList = NULL;
+    const char *fen = "startpos", *variant;
+    int chess960 = false;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "s|sO!p", const_cast<char**>(kwlist),
+                                     &variant, &fen, &PyList_Type, &moveList, &chess960)) {
+        return -1;
+    }
+
+    auto it = variants.find(std::string(variant));
+    if (it == variants.end())
+    {
+        PyErr_SetString(PyExc_ValueError, (std::string("No such variant '") + variant + "'").c_str());
+        return -1;
+    }
+
+    delete self->board;
+    BoardState* b = self->board = new BoardState();
+    b->v = it->second;
+    b->states = StateListPtr(new std::deque<StateInfo>(1));
+    UCI::init_variant(b->v);
+    if (strcmp(fen, "startpos") == 0)
+        fen = b->v->startFen.c_str();
+    b->pos.set(b->v, std::string(fen), chess960, &b->states->back(), Threads.main());
+
+    int numMoves = moveList ? PyList_Size(moveList) : 0;
+    for (int i = 0; i < numMoves ; i++)
+    {
+        PyObject *MoveStr = PyUnicode_AsEncodedString( PyList_GetItem(moveList, i), "UTF-8", "strict");
+        std::string moveStr(PyBytes_AS_STRING(MoveStr));
+        Py_XDECREF(MoveStr);
+        if (!board_push(b, moveStr))
+            return -1;
+    }
+    return 0;
+}
+
+// INPUT move
+static PyObject* Board_push(PyBoard* self, PyObject *args) {
+    const char *move;
+    if (!PyArg_ParseTuple(args, "s", &move)) {
+        return NULL;
+    }
+
+    BoardState* b = board_state(self);
+    if (!b || !board_push(b, move))
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+static PyObject* Board_pop(PyBoard* self) {
+    BoardState* b = board_state(self);
+    if (!b)
+        return NULL;
+    if (b->moveStack.empty())
+    {
+        PyErr_SetString(PyExc_IndexError, "pop from board without moves");
+        return NULL;
+    }
+
+    Move m = b->moveStack.back();
+    b->pos.undo_move(m);
+    b->moveStack.pop_back();
+    b->states->pop_back();
+    return Py_BuildValue("s", UCI::move(b->pos, m).c_str());
+}
+
+static PyObject* Board_legalMoves(PyBoard* self) {
+    BoardState* b = board_state(self);
+    if (!b)
+        return NULL;
+    PyObject* legalMoves = PyList_New(0);
+    const Position& pos = b->pos;
+    for (const auto& m : MoveList<LEGAL>(pos))
+    {
+        PyObject *moveStr;
+        moveStr = Py_BuildValue("s", UCI::move(pos, m).c_str());
+        PyList_Append(legalMoves, moveStr);
+        Py_XDECREF(moveStr);
+    }
+    return legalMoves;
+}
+
+static PyObject* Board_fen(PyBoard* self, PyObject *args, PyObject *kwds) {
+    static const char* kwlist[] = {"sfen", "show_promoted", "count_started", NULL};
+    int sfen = false, showPromoted = false, countStarted = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|ppi", const_cast<char**>(kwlist), &sfen, &showPromoted, &countStarted)) {
+        return NULL;
+    }
+
+    BoardState* b = board_state(self);
+    if (!b)
+        return NULL;
+    return Py_BuildValue("s", b->pos.fen(sfen, showPromoted, countStarted).c_str());
+}
+
+// Result for the side to move as in game_result(), or None while the game goes on
+static PyObject* Board_result(PyBoard* self) {
+    BoardState* b = board_state(self);
+    if (!b)
+        return NULL;
+    const Position& pos = b->pos;
+    Value result;
+    if (!pos.is_immediate_game_end(result))
+    {
+        if (MoveList<LEGAL>(pos).size())
+            Py_RETURN_NONE;
+        result = pos.checkers() ? pos.checkmate_value() : pos.stalemate_value();
+    }
+    return Py_BuildValue("i", result);
+}
+
+// Incrementally updated Urbino scores of white and black
+static PyObject* Board_urbinoScores(PyBoard* self) {
+    BoardState* b = board_state(self);
+    if (!b)
+        return NULL;
+    const Position& pos = b->pos;
+    return Py_BuildValue("(ii)", pos.urbino_score(WHITE), pos.urbino_score(BLACK));
+}
+
+static PyMethodDef BoardMethods[] = {
+    {"push", (PyCFunction)Board_push, METH_VARARGS, "Play a UCI move."},
+    {"pop", (PyCFunction)Board_pop, METH_NOARGS, "Take back the last move and return it."},
+    {"legal_moves", (PyCFunction)Board_legalMoves, METH_NOARGS, "Get legal moves."},
+    {"fen", (PyCFunction)Board_fen, METH_VARARGS | METH_KEYWORDS, "Get FEN."},
+    {"result", (PyCFunction)Board_result, METH_NOARGS, "Get result for the side to move, or None if the game is not over."},
+    {"urbino_scores", (PyCFunction)Board_urbinoScores, METH_NOARGS, "Get Urbino scores of white and black."},
+    {NULL, NULL, 0, NULL},  // sentinel
+};
+
+static PyTypeObject PyBoardType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+};
+
 static PyMethodDef PyFFishMethods[] = {
     {"version", (PyCFunction)pyffish_version, METH_NOARGS, "Get package version."},
     {"info", (PyCFunction)pyffish_info, METH_NOARGS, "Get Stockfish version info."},
@@ -422,6 +781,8 @@ static PyMethodDef PyFFishMethods[] = {
     {"has_insufficient_material", (PyCFunction)pyffish_hasInsufficientMaterial, METH_VARARGS, "Checks for insufficient material."},
     {"validate_fen", (PyCFunction)pyffish_validateFen, METH_VARARGS, "Validate an input FEN."},
     {"get_fog_fen", (PyCFunction)pyffish_getFogFEN, METH_VARARGS, "Get Fog of War FEN from given FEN."},
+    {"legal_moves_batch", (PyCFunction)pyffish_legalMovesBatch, METH_VARARGS, "Get legal moves for a list of (FEN, movelist) pairs, with as many worker threads as the Threads option."},
+    {"game_result_batch", (PyCFunction)pyffish_gameResultBatch, METH_VARARGS, "Get results, or None if the game is not over, for a list of (FEN, movelist) pairs, with as many worker threads as the Threads option."},
     {NULL, NULL, 0, NULL},  // sentinel
 };
 
@@ -444,6 +805,21 @@ PyMODINIT_FUNC PyInit_pyffish() {
     Py_INCREF(PyFFishError);
     PyModule_AddObject(module, "error", PyFFishError);
 
+    // board type
+    PyBoardType.tp_name = "pyffish.Board";
+    PyBoardType.tp_doc = "Position of a game, updated incrementally by push and pop.";
+    PyBoardType.tp_basicsize = sizeof(PyBoard);
+    PyBoardType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE;
+    PyBoardType.tp_new = PyType_GenericNew;
+    PyBoardType.tp_init = (initproc)Board_init;
+    PyBoardType.tp_dealloc = (destructor)Board_dealloc;
+    PyBoardType.tp_methods = BoardMethods;
+    if (PyType_Ready(&PyBoardType) < 0) {
+        return NULL;
+    }
+    Py_INCREF(&PyBoardType);
+    PyModule_AddObject(module, "Board", (PyObject*)&PyBoardType);
+
     // values
     PyModule_AddObject(module, "VALUE_MATE", PyLong_FromLong(VALUE_MATE));
     PyModule_AddObject(module, "VALUE_DRAW", PyLong_FromLong(VALUE_DRAW));
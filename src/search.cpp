@@ -20,10 +20,13 @@
 #include <cassert>
 #include <cmath>
 #include <cstring>   // For std::memset
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 
+#include "book.h"
 #include "evaluate.h"
+#include "mcts.h"
 #include "misc.h"
 #include "movegen.h"
 #include "movepick.h"
@@ -98,7 +101,7 @@ namespace {
     explicit Skill(int l) : level(l) {}
     bool enabled() const { return level < 20; }
     bool time_to_pick(Depth depth) const { return depth == 1 + std::max(level, 0); }
-    Move pick_best(size_t multiPV);
+    Move pick_best(const RootLines& rootLines, size_t multiPV);
 
     int level;
     Move best = MOVE_NONE;
@@ -120,8 +123,11 @@ namespace {
 
   // perft() is our utility to verify move generation. All the leaf nodes up
   // to the given depth are generated and counted, and the sum is returned.
+  // The legal moves of every node but the leaves are also added to 'hash',
+  // mixed with the position key, so that two move generators can be checked
+  // to produce the same moves and not only the same number of them.
   template<bool Root>
-  uint64_t perft(Position& pos, Depth depth) {
+  uint64_t perft(Position& pos, Depth depth, Key& hash) {
 
     // if (Root) {
     //     sync_cout << "DEBUG perft entry: total_pieces=" << popcount(pos.pieces())
@@ -147,12 +153,21 @@ namespace {
         //               << " houses=" << popcount(pos.pieces(CUSTOM_PIECE_2)) << sync_endl;
         // }
         assert(pos.pseudo_legal(m)); // for urbino, in debug mode, this generates (nearly) all moves again!
+        hash += make_key(pos.key() ^ make_key(Move(m)));
         if (Root && depth <= 1)
             cnt = 1, nodes++;
         else
         {
             pos.do_move(m, st);
-            cnt = leaf ? MoveList<LEGAL>(pos).size() : perft<false>(pos, depth - 1);
+            if (leaf)
+            {
+                MoveList<LEGAL> moves(pos);
+                cnt = moves.size();
+                for (const auto& lm : moves)
+                    hash += make_key(pos.key() ^ make_key(Move(lm)));
+            }
+            else
+                cnt = perft<false>(pos, depth - 1, hash);
             nodes += cnt;
             pos.undo_move(m);
         }
@@ -162,6 +177,151 @@ namespace {
     return nodes;
   }
 
+  // Root splitting for wide Urbino roots. During the first iterations the
+  // root moves are handed out one at a time to whichever thread is free, so
+  // that the threads share the root instead of all searching it (idle threads
+  // effectively steal the remaining moves). Deeper iterations use Lazy SMP.
+  constexpr Depth RootSplitDepth = 3;
+
+  struct SplitIteration {
+    std::atomic<size_t> next, done;
+    std::atomic<int> best;
+    std::vector<Value> scores;
+    std::vector<std::vector<Move>> pvs;
+  };
+
+  struct RootSplit {
+    bool active;
+    SplitIteration iterations[RootSplitDepth + 1];
+  };
+
+  RootSplit Split;
+
+  // init_root_split() is called by the main thread before the helper threads
+  // are woken up and decides whether the root is worth splitting.
+  void init_root_split(const Position& pos, size_t moveCount) {
+
+    Split.active =  pos.urbino_gating()
+                 && Threads.size() > 1
+                 && moveCount >= 2 * Threads.size()
+                 && int(Options["MultiPV"]) == 1
+                 && int(Options["Skill Level"]) == 20
+                 && !Options["UCI_LimitStrength"];
+
+    if (!Split.active)
+        return;
+
+    for (SplitIteration& it : Split.iterations)
+    {
+        it.next = it.done = 0;
+        it.best = -VALUE_INFINITE;
+        it.scores.assign(moveCount, -VALUE_INFINITE);
+        it.pvs.assign(moveCount, std::vector<Move>());
+    }
+  }
+
+  // split_root() searches one root iteration together with the other
+  // threads. Each move is searched with a null window around the best score
+  // found so far by any thread and re-searched if it beats it. Once all the
+  // moves are done the results are copied into the thread's root lines.
+  Value split_root(Thread* thisThread, Stack* ss, Depth depth) {
+
+    SplitIteration& it = Split.iterations[depth];
+    Position& pos = thisThread->rootPos;
+    RootLines& rootLines = thisThread->rootLines;
+    MainThread* mainThread = (thisThread == Threads.main() ? Threads.main() : nullptr);
+    const size_t n = rootLines.size();
+    Move pv[MAX_PLY+1];
+    StateInfo st;
+    ASSERT_ALIGNED(&st, Eval::NNUE::CacheLineSize);
+
+    thisThread->pvIdx = 0;
+    thisThread->selDepth = 0;
+    ss->inCheck = pos.checkers();
+    ss->staticEval = ss->inCheck ? VALUE_NONE : evaluate(pos);
+    ss->ttPv = true;
+    ss->ttHit = false;
+    ss->statScore = 0;
+
+    for (size_t i; !Threads.stop && (i = it.next.fetch_add(1, std::memory_order_relaxed)) < n; )
+    {
+        Move move = rootLines[i].move();
+        Value alpha = Value(it.best.load(std::memory_order_relaxed));
+        Value value;
+
+        ss->moveCount = int(i) + 1;
+        ss->currentMove = move;
+        ss->continuationHistory = &thisThread->continuationHistory[ss->inCheck]
+                                                                  [pos.capture_or_promotion(move)]
+                                                                  [history_slot(pos.moved_piece(move))]
+                                                                  [to_sq(move)];
+        uint64_t nodeCount = thisThread->nodes;
+        pos.do_move(move, st);
+
+        if (alpha == -VALUE_INFINITE)
+            value = VALUE_INFINITE;
+        else
+            value = -search<NonPV>(pos, ss+1, -(alpha+1), -alpha, depth - 1, true);
+
+        if (value > alpha && !Threads.stop)
+        {
+            (ss+1)->pv = pv;
+            (ss+1)->pv[0] = MOVE_NONE;
+            value = -search<PV>(pos, ss+1, -VALUE_INFINITE, -alpha, depth - 1, false);
+        }
+
+        pos.undo_move(move);
+        rootLines[i].effort += thisThread->nodes - nodeCount;
+
+        if (Threads.stop)
+            break;
+
+        // A move that failed low keeps its upper bound and loses its old PV
+        it.scores[i] = value;
+        it.pvs[i].assign(1, move);
+
+        if (value > alpha)
+        {
+            for (Move* m = pv; *m != MOVE_NONE; ++m)
+                it.pvs[i].push_back(*m);
+
+            int best = it.best.load(std::memory_order_relaxed);
+            while (value > best && !it.best.compare_exchange_weak(best, value))
+            {}
+        }
+
+        it.done.fetch_add(1, std::memory_order_release);
+    }
+
+    // Wait for the moves still searched by other threads
+    while (it.done.load(std::memory_order_acquire) < n && !Threads.stop)
+    {
+        if (mainThread)
+            mainThread->check_time();
+        std::this_thread::yield();
+    }
+
+    if (Threads.stop)
+        return rootLines[0].score;
+
+    Move previousBest = rootLines[0].move();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        rootLines[i].score = it.scores[i];
+        rootLines[i].selDepth = std::max(thisThread->selDepth, depth);
+        rootLines[i].pv = it.pvs[i];
+    }
+
+    std::stable_sort(rootLines.begin(), rootLines.end());
+
+    // As in search(), a new best move counts as a change for time management
+    if (rootLines[0].move() != previousBest)
+        ++thisThread->bestMoveChanges;
+
+    return rootLines[0].score;
+  }
+
 } // namespace
 
 
@@ -181,12 +341,86 @@ void Search::clear() {
   Threads.main()->wait_for_search_finished();
 
   Time.availableNodes = 0;
-  TT.clear();
+
+  // A table read from a file ("tt load" or the "TT File" option) is restored
+  // instead of emptied, so that a new game starts from its contents again.
+  if (!TT.reload())
+      TT.clear();
+
+  MCTS::clear();
   Threads.clear();
   Tablebases::init(Options["SyzygyPath"]); // Free mapped files
 }
 
 
+/// Search::seed_root_moves() orders the root moves with what the previous
+/// search left behind, see the "Keep Search State" option. The TT scores of
+/// the child positions order the moves for the first iteration, which matters
+/// for wide roots whose moves would otherwise start in generation order. When
+/// the root did not change, the node counts of its moves are kept too. When
+/// it was reached by the move and the reply of the previous PV, the rest of
+/// that PV is promoted: its first move is searched first, with the PV.
+
+void Search::seed_root_moves(Position& pos, RootMoves& rootMoves, const RootLines& previous, Key previousKey,
+                             const TranspositionTable& tt) {
+
+  StateInfo st;
+  const StateInfo* s = pos.state();
+  const bool sameRoot = pos.key() == previousKey;
+  std::vector<Move> promotedPv;
+  std::vector<std::pair<Value, size_t>> order;
+
+  if (   !previous.empty()
+      && previous[0].pv.size() > 2
+      && s->previous
+      && s->previous->previous
+      && s->previous->previous->key == previousKey
+      && s->previous->move == previous[0].pv[0]
+      && s->move == previous[0].pv[1])
+      promotedPv.assign(previous[0].pv.begin() + 2, previous[0].pv.end());
+
+  for (RootMove& rm : rootMoves)
+  {
+      order.emplace_back(-VALUE_INFINITE, order.size());
+
+      if (sameRoot)
+      {
+          auto prev = std::find(previous.begin(), previous.end(), rm.move);
+          if (prev != previous.end())
+              rm.effort = prev->effort;
+      }
+
+      if (!promotedPv.empty() && rm.move == promotedPv[0])
+      {
+          rm.pv = promotedPv;
+          order.back().first = VALUE_INFINITE;
+          continue;
+      }
+
+      bool ttHit;
+      pos.do_move(rm.move, st);
+      TTEntry* tte = tt.probe(pos.key(), ttHit);
+      Value v = ttHit ? value_from_tt(tte->value(), 1, pos.rule50_count()) : VALUE_NONE;
+      order.back().first = v != VALUE_NONE ? -v : -VALUE_INFINITE;
+      pos.undo_move(rm.move);
+  }
+
+  std::stable_sort(order.begin(), order.end(),
+                   [&](const std::pair<Value, size_t>& a, const std::pair<Value, size_t>& b) {
+                       const RootMove& ra = rootMoves[a.second];
+                       const RootMove& rb = rootMoves[b.second];
+                       return ra.tbRank != rb.tbRank ? ra.tbRank > rb.tbRank
+                            : a.first   != b.first   ? a.first   > b.first
+                                                     : ra.effort > rb.effort; });
+
+  RootMoves sorted;
+  sorted.reserve(rootMoves.size());
+  for (const auto& o : order)
+      sorted.push_back(std::move(rootMoves[o.second]));
+  rootMoves = std::move(sorted);
+}
+
+
 /// MainThread::search() is started when the program receives the UCI 'go'
 /// command. It searches from the root position and outputs the "bestmove".
 
@@ -196,26 +430,41 @@ void MainThread::search() {
 //       sync_cout << "DEBUG: MainThread::search() called, stop=" << Threads.stop << sync_endl;
 //   }
 
-  if (Limits.perft)
+  if (pool.limits.perft)
   {
-      nodes = perft<true>(rootPos, Limits.perft);
-      sync_cout << "\nNodes searched: " << nodes << "\n" << sync_endl;
+      Key hash = 0;
+      nodes = perft<true>(rootPos, pool.limits.perft, hash);
+      sync_cout << "\nNodes searched: " << nodes
+                << "\nMove hash: " << std::hex << std::setfill('0') << std::setw(16) << hash
+                << std::dec << std::setfill(' ') << "\n" << sync_endl;
       return;
   }
 
+  // Each thread sets up its own lines over the shared root moves, the helper
+  // threads do it in Thread::search()
+  for (const RootMove& rm : pool.rootMoves)
+      rootLines.emplace_back(rm);
+
+  // Only the UCI pool talks to the GUI. The private pools of the selfplay
+  // commands search silently and leave their result in bestThread.
+  const bool silent = &pool != &Threads;
+
   Color us = rootPos.side_to_move();
-  Time.init(rootPos, Limits, us, rootPos.game_ply());
-  TT.new_search();
+  pool.time.init(rootPos, pool.limits, us, rootPos.game_ply());
+  pool.tt.new_search();
 
   Eval::NNUE::verify();
 
 //   if (rootPos.urbino_gating()) {
-//       sync_cout << "DEBUG: MainThread::search urbino - rootMoves.size()=" << rootMoves.size() << sync_endl;
+//       sync_cout << "DEBUG: MainThread::search urbino - rootLines.size()=" << rootLines.size() << sync_endl;
 //   }
 
-  if (rootMoves.empty() || (CurrentProtocol == XBOARD && rootPos.is_optional_game_end()))
+  bool bookHit = false;
+
+  if (rootLines.empty() || (CurrentProtocol == XBOARD && rootPos.is_optional_game_end()))
   {
-      rootMoves.emplace_back(MOVE_NONE);
+      static const RootMove None(MOVE_NONE);
+      rootLines.emplace_back(None);
       Value variantResult;
       Value result =  rootPos.is_game_end(variantResult) ? variantResult
                     : rootPos.checkers()                 ? rootPos.checkmate_value()
@@ -223,27 +472,52 @@ void MainThread::search() {
       if (CurrentProtocol == XBOARD)
       {
           // rotate MOVE_NONE to front (for optional game end)
-          std::rotate(rootMoves.rbegin(), rootMoves.rbegin() + 1, rootMoves.rend());
+          std::rotate(rootLines.rbegin(), rootLines.rbegin() + 1, rootLines.rend());
+          if (!silent)
           sync_cout << (  result == VALUE_DRAW ? "1/2-1/2 {Draw}"
                         : (rootPos.side_to_move() == BLACK ? -result : result) == VALUE_MATE ? "1-0 {White wins}"
                         : "0-1 {Black wins}")
                     << sync_endl;
       }
-      else
+      else if (!silent)
       sync_cout << "info depth 0 score "
                 << UCI::value(result)
                 << sync_endl;
   }
   else
   {
-      Threads.start_searching(); // start non-main threads
-      Thread::search();          // main thread start searching
+      // Play a book move, if any, without starting the other threads
+      Value bookScore = VALUE_NONE;
+      Move bookMove = pool.limits.infinite || pool.limits.mate || pool.limits.perft ? MOVE_NONE : Book::probe(rootPos, bookScore);
+      auto it = std::find(rootLines.begin(), rootLines.end(), bookMove);
+
+      if (bookMove && it != rootLines.end())
+      {
+          std::swap(rootLines[0], *it);
+          rootLines[0].score = bookScore;
+          bookHit = true;
+          if (!silent)
+          sync_cout << "info string book move " << UCI::move(rootPos, bookMove)
+                    << " score " << UCI::value(bookScore) << sync_endl;
+      }
+      else
+      {
+          assert(!silent || !MCTS::enabled()); // The MCTS tree is global
+
+          if (MCTS::enabled())
+              MCTS::prepare(rootPos);
+          else if (!silent) // So is the root split state
+              init_root_split(rootPos, rootLines.size());
+
+          pool.start_searching(); // start non-main threads
+          Thread::search();          // main thread start searching
+      }
   }
 
   // Sit in bughouse variants if partner requested it or we are dead
-  if (rootPos.two_boards() && !Threads.abort && CurrentProtocol == XBOARD)
+  if (rootPos.two_boards() && !pool.abort && CurrentProtocol == XBOARD)
   {
-      while (!Threads.stop && (Partner.sitRequested || (Partner.weDead && !Partner.partnerDead)) && Time.elapsed() < Limits.time[us] - 1000)
+      while (!pool.stop && (Partner.sitRequested || (Partner.weDead && !Partner.partnerDead)) && pool.time.elapsed() < pool.limits.time[us] - 1000)
       {}
   }
 
@@ -253,30 +527,34 @@ void MainThread::search() {
   // GUI sends a "stop" or "ponderhit" command. We therefore simply wait here
   // until the GUI sends one of those commands.
 
-  while (!Threads.stop && (ponder || Limits.infinite))
+  while (!pool.stop && (ponder || pool.limits.infinite))
   {} // Busy wait for a stop or a ponder reset
 
   // Stop the threads if not already stopped (also raise the stop if
   // "ponderhit" just reset Threads.ponder).
-  Threads.stop = true;
+  pool.stop = true;
 
   // Wait until all threads have finished
-  Threads.wait_for_search_finished();
+  pool.wait_for_search_finished();
 
   // When playing in 'nodes as time' mode, subtract the searched nodes from
   // the available ones before exiting.
-  if (Limits.npmsec)
-      Time.availableNodes += Limits.inc[us] - Threads.nodes_searched();
+  if (pool.limits.npmsec)
+      pool.time.availableNodes += pool.limits.inc[us] - pool.nodes_searched();
 
   bestThread = this;
 
-  if (   int(Options["MultiPV"]) == 1
-      && !Limits.depth
-      && !(Skill(Options["Skill Level"]).enabled() || int(Options["UCI_LimitStrength"]))
-      && rootMoves[0].pv[0] != MOVE_NONE)
-      bestThread = Threads.get_best_thread();
+  if (   int(pool.options["MultiPV"]) == 1
+      && !bookHit
+      && !pool.limits.depth
+      && !(Skill(pool.options["Skill Level"]).enabled() || int(pool.options["UCI_LimitStrength"]))
+      && rootLines[0].move() != MOVE_NONE)
+      bestThread = pool.get_best_thread();
+
+  bestPreviousScore = bestThread->rootLines[0].score;
 
-  bestPreviousScore = bestThread->rootMoves[0].score;
+  if (silent)
+      return;
 
   // Send again PV info if we have a new best thread
   if (bestThread != this)
@@ -284,24 +562,24 @@ void MainThread::search() {
 
   if (CurrentProtocol == XBOARD)
   {
-      Move bestMove = bestThread->rootMoves[0].pv[0];
+      Move bestMove = bestThread->rootLines[0].move();
       // Wait for virtual drop to become real
       if (rootPos.two_boards() && rootPos.virtual_drop(bestMove))
       {
           Partner.ptell("fast");
-          while (!Threads.abort && !Partner.partnerDead && !Partner.fast && Limits.time[us] - Time.elapsed() > Partner.opptime)
+          while (!pool.abort && !Partner.partnerDead && !Partner.fast && pool.limits.time[us] - pool.time.elapsed() > Partner.opptime)
           {}
           Partner.ptell("x");
           // Find best real move
-          for (const auto& m : this->rootMoves)
-              if (!rootPos.virtual_drop(m.pv[0]))
+          for (const auto& m : this->rootLines)
+              if (!rootPos.virtual_drop(m.move()))
               {
-                  bestMove = m.pv[0];
+                  bestMove = m.move();
                   break;
               }
       }
       // Send move only when not in analyze mode and not at game end
-      if (!Limits.infinite && !ponder && rootMoves[0].pv[0] != MOVE_NONE && !Threads.abort.exchange(true))
+      if (!pool.limits.infinite && !ponder && rootLines[0].move() != MOVE_NONE && !pool.abort.exchange(true))
       {
           std::string move = UCI::move(rootPos, bestMove);
           if (rootPos.walling())
@@ -315,18 +593,18 @@ void MainThread::search() {
           {
               XBoard::stateMachine->do_move(bestMove);
               XBoard::stateMachine->moveAfterSearch = false;
-              if (Options["Ponder"] && (   bestThread->rootMoves[0].pv.size() > 1
-                                        || bestThread->rootMoves[0].extract_ponder_from_tt(rootPos)))
-                  XBoard::stateMachine->ponderMove = bestThread->rootMoves[0].pv[1];
+              if (Options["Ponder"] && (   bestThread->rootLines[0].pv.size() > 1
+                                        || bestThread->rootLines[0].extract_ponder_from_tt(rootPos)))
+                  XBoard::stateMachine->ponderMove = bestThread->rootLines[0].pv[1];
           }
       }
       return;
   }
 
-  sync_cout << "bestmove " << UCI::move(rootPos, bestThread->rootMoves[0].pv[0]);
+  sync_cout << "bestmove " << UCI::move(rootPos, bestThread->rootLines[0].move());
 
-  if (bestThread->rootMoves[0].pv.size() > 1 || bestThread->rootMoves[0].extract_ponder_from_tt(rootPos))
-      std::cout << " ponder " << UCI::move(rootPos, bestThread->rootMoves[0].pv[1]);
+  if (bestThread->rootLines[0].pv.size() > 1 || bestThread->rootLines[0].extract_ponder_from_tt(rootPos))
+      std::cout << " ponder " << UCI::move(rootPos, bestThread->rootLines[0].pv[1]);
 
   std::cout << sync_endl;
 }
@@ -338,6 +616,16 @@ void MainThread::search() {
 
 void Thread::search() {
 
+  if (this != pool.main())
+      for (const RootMove& rm : pool.rootMoves)
+          rootLines.emplace_back(rm);
+
+  if (MCTS::enabled())
+  {
+      MCTS::search(this);
+      return;
+  }
+
   // To allow access to (ss-7) up to (ss+2), the stack must be oversized.
   // The former is needed to allow update_continuation_histories(ss-1, ...),
   // which accesses its argument at ss-6, also near the root.
@@ -347,7 +635,8 @@ void Thread::search() {
   Value bestValue, alpha, beta, delta;
   Move  lastBestMove = MOVE_NONE;
   Depth lastBestMoveDepth = 0;
-  MainThread* mainThread = (this == Threads.main() ? Threads.main() : nullptr);
+  MainThread* mainThread = (this == pool.main() ? pool.main() : nullptr);
+  const bool silent = &pool != &Threads; // See MainThread::search()
   double timeReduction = 1, totBestMoveChanges = 0;
   Color us = rootPos.side_to_move();
   int iterIdx = 0;
@@ -377,7 +666,16 @@ void Thread::search() {
   std::copy(&lowPlyHistory[2][0], &lowPlyHistory.back().back() + 1, &lowPlyHistory[0][0]);
   std::fill(&lowPlyHistory[MAX_LPH - 2][0], &lowPlyHistory.back().back() + 1, 0);
 
-  size_t multiPV = size_t(Options["MultiPV"]);
+  // When keeping the search state between moves, age the histories so that
+  // the statistics of the previous search fade out instead of piling up.
+  if (pool.options["Keep Search State"])
+  {
+      mainHistory.scale(3, 4);
+      gateHistory.scale(3, 4);
+      captureHistory.scale(3, 4);
+  }
+
+  size_t multiPV = size_t(pool.options["MultiPV"]);
 
   // Pick integer skill levels, but non-deterministically round up or down
   // such that the average integer skill corresponds to the input floating point one.
@@ -385,12 +683,12 @@ void Thread::search() {
   // to CCRL Elo (goldfish 1.13 = 2000) and a fit through Ordo derived Elo
   // for match (TC 60+0.6) results spanning a wide range of k values.
   PRNG rng(now());
-  double shiftedElo = Options["UCI_Elo"] - 1346.6;
-  double floatLevel = Options["UCI_LimitStrength"] ?
+  double shiftedElo = pool.options["UCI_Elo"] - 1346.6;
+  double floatLevel = pool.options["UCI_LimitStrength"] ?
                       std::clamp(shiftedElo > 0 ? std::pow(shiftedElo / 143.4, 1 / 0.806)
                                                 : shiftedElo / 143.4 + std::pow(shiftedElo / 500, 5),
                                  -20.0, 20.0) :
-                        double(Options["Skill Level"]);
+                        double(pool.options["Skill Level"]);
   int intLevel = int(floatLevel) +
                  ((floatLevel - int(floatLevel)) * 1024 > rng.rand<unsigned>() % 1024  ? 1 : 0);
   Skill skill(intLevel);
@@ -400,7 +698,7 @@ void Thread::search() {
   if (skill.enabled())
       multiPV = std::max(multiPV, (size_t)4);
 
-  multiPV = std::min(multiPV, rootMoves.size());
+  multiPV = std::min(multiPV, rootLines.size());
   ttHitAverage = TtHitAverageWindow * TtHitAverageResolution / 2;
 
   trend = SCORE_ZERO;
@@ -409,14 +707,14 @@ void Thread::search() {
 
   // Iterative deepening loop until requested to stop or the target depth is reached
 //   if (rootPos.urbino_gating() && mainThread) {
-//       sync_cout << "DEBUG: Starting iterative deepening, rootMoves.size()=" << rootMoves.size()
+//       sync_cout << "DEBUG: Starting iterative deepening, rootLines.size()=" << rootLines.size()
 //                 << " Threads.stop=" << Threads.stop
 //                 << " rootDepth=" << rootDepth
 //                 << " Limits.depth=" << Limits.depth << sync_endl;
 //   }
   while (   ++rootDepth < MAX_PLY
-         && !Threads.stop
-         && !(Limits.depth && mainThread && rootDepth > Limits.depth))
+         && !pool.stop
+         && !(pool.limits.depth && mainThread && rootDepth > pool.limits.depth))
   {
     //   if (rootPos.urbino_gating() && mainThread) {
     //       sync_cout << "DEBUG: In loop, rootDepth=" << rootDepth << " stop=" << Threads.stop << sync_endl;
@@ -427,23 +725,34 @@ void Thread::search() {
 
       // Save the last iteration's scores before first PV line is searched and
       // all the move scores except the (new) PV are set to -VALUE_INFINITE.
-      for (RootMove& rm : rootMoves)
+      for (RootLine& rm : rootLines)
           rm.previousScore = rm.score;
 
       size_t pvFirst = 0;
       pvLast = 0;
 
-      if (!Threads.increaseDepth)
+      if (!pool.increaseDepth)
          searchAgainCounter++;
 
+      // The first iterations of a wide Urbino root are shared out among the
+      // threads move by move, see split_root().
+      bool splitIteration = !silent && Split.active && rootDepth <= RootSplitDepth;
+      if (splitIteration)
+      {
+          bestValue = split_root(this, ss, rootDepth);
+
+          if (mainThread)
+              sync_cout << UCI::pv(rootPos, rootDepth, -VALUE_INFINITE, VALUE_INFINITE) << sync_endl;
+      }
+
       // MultiPV loop. We perform a full root search for each PV line
-      for (pvIdx = 0; pvIdx < multiPV && !Threads.stop; ++pvIdx)
+      for (pvIdx = 0; pvIdx < multiPV && !pool.stop && !splitIteration; ++pvIdx)
       {
           if (pvIdx == pvLast)
           {
               pvFirst = pvLast;
-              for (pvLast++; pvLast < rootMoves.size(); pvLast++)
-                  if (rootMoves[pvLast].tbRank != rootMoves[pvFirst].tbRank)
+              for (pvLast++; pvLast < rootLines.size(); pvLast++)
+                  if (rootLines[pvLast].root->tbRank != rootLines[pvFirst].root->tbRank)
                       break;
           }
 
@@ -453,7 +762,7 @@ void Thread::search() {
           // Reset aspiration window starting size
           if (rootDepth >= 4)
           {
-              Value prev = rootMoves[pvIdx].previousScore;
+              Value prev = rootLines[pvIdx].previousScore;
               delta = Value(17 * (1 + rootPos.captures_to_hand()));
               alpha = std::max(prev - delta,-VALUE_INFINITE);
               beta  = std::min(prev + delta, VALUE_INFINITE);
@@ -480,20 +789,21 @@ void Thread::search() {
               // and we want to keep the same order for all the moves except the
               // new PV that goes to the front. Note that in case of MultiPV
               // search the already searched PV lines are preserved.
-              std::stable_sort(rootMoves.begin() + pvIdx, rootMoves.begin() + pvLast);
+              std::stable_sort(rootLines.begin() + pvIdx, rootLines.begin() + pvLast);
 
               // If search has been stopped, we break immediately. Sorting is
-              // safe because RootMoves is still valid, although it refers to
+              // safe because RootLines is still valid, although it refers to
               // the previous iteration.
-              if (Threads.stop)
+              if (pool.stop)
                   break;
 
               // When failing high/low give some update (without cluttering
               // the UI) before a re-search.
               if (   mainThread
+                  && !silent
                   && multiPV == 1
                   && (bestValue <= alpha || bestValue >= beta)
-                  && Time.elapsed() > 3000)
+                  && pool.time.elapsed() > 3000)
                   sync_cout << UCI::pv(rootPos, rootDepth, alpha, beta) << sync_endl;
 
               // In case of failing low/high increase aspiration window and
@@ -521,37 +831,38 @@ void Thread::search() {
           }
 
           // Sort the PV lines searched so far and update the GUI
-          std::stable_sort(rootMoves.begin() + pvFirst, rootMoves.begin() + pvIdx + 1);
+          std::stable_sort(rootLines.begin() + pvFirst, rootLines.begin() + pvIdx + 1);
 
           if (    mainThread
-              && (Threads.stop || pvIdx + 1 == multiPV || Time.elapsed() > 3000))
+              && !silent
+              && (pool.stop || pvIdx + 1 == multiPV || pool.time.elapsed() > 3000))
               sync_cout << UCI::pv(rootPos, rootDepth, alpha, beta) << sync_endl;
       }
 
-      if (!Threads.stop)
+      if (!pool.stop)
           completedDepth = rootDepth;
 
-      if (rootMoves[0].pv[0] != lastBestMove) {
-         lastBestMove = rootMoves[0].pv[0];
+      if (rootLines[0].move() != lastBestMove) {
+         lastBestMove = rootLines[0].move();
          lastBestMoveDepth = rootDepth;
       }
 
       // Have we found a "mate in x"?
-      if (   Limits.mate
+      if (   pool.limits.mate
           && bestValue >= VALUE_MATE_IN_MAX_PLY
-          && VALUE_MATE - bestValue <= 2 * Limits.mate)
-          Threads.stop = true;
+          && VALUE_MATE - bestValue <= 2 * pool.limits.mate)
+          pool.stop = true;
 
       if (!mainThread)
           continue;
 
       // If skill level is enabled and time is up, pick a sub-optimal best move
       if (skill.enabled() && skill.time_to_pick(rootDepth))
-          skill.pick_best(multiPV);
+          skill.pick_best(rootLines, multiPV);
 
       // Do we have time for the next iteration? Can we stop searching now?
-      if (    Limits.use_time_management()
-          && !Threads.stop
+      if (    pool.limits.use_time_management()
+          && !pool.stop
           && !mainThread->stopOnPonderhit)
       {
           double fallingEval = (318 + 6 * (mainThread->bestPreviousScore - bestValue)
@@ -563,28 +874,28 @@ void Thread::search() {
           double reduction = (1.47 + mainThread->previousTimeReduction) / (2.32 * timeReduction);
 
           // Use part of the gained time from a previous stable move for the current move
-          for (Thread* th : Threads)
+          for (Thread* th : pool)
           {
               totBestMoveChanges += th->bestMoveChanges;
               th->bestMoveChanges = 0;
           }
           double bestMoveInstability = 1.073 + std::max(1.0, 2.25 - 9.9 / rootDepth)
-                                              * totBestMoveChanges / Threads.size();
-          double totalTime = Time.optimum() * fallingEval * reduction * bestMoveInstability;
+                                              * totBestMoveChanges / pool.size();
+          double totalTime = pool.time.optimum() * fallingEval * reduction * bestMoveInstability;
 
           // Cap used time in case of a single legal move for a better viewer experience in tournaments
           // yielding correct scores and sufficiently fast moves.
-          if (rootMoves.size() == 1)
+          if (rootLines.size() == 1)
               totalTime = std::min(500.0, totalTime);
 
           // Update partner in bughouse variants
           if (completedDepth >= 8 && rootPos.two_boards() && CurrentProtocol == XBOARD)
           {
               // Communicate clock times relevant for sitting decisions
-              if (Limits.time[us])
-                  Partner.ptell<FAIRY>("time " + std::to_string((Limits.time[us] - Time.elapsed()) / 10));
-              if (Limits.time[~us])
-                  Partner.ptell<FAIRY>("otim " + std::to_string(Limits.time[~us] / 10));
+              if (pool.limits.time[us])
+                  Partner.ptell<FAIRY>("time " + std::to_string((pool.limits.time[us] - pool.time.elapsed()) / 10));
+              if (pool.limits.time[~us])
+                  Partner.ptell<FAIRY>("otim " + std::to_string(pool.limits.time[~us] / 10));
               // We are dead and need to sit
               if (!Partner.weDead && bestValue <= VALUE_MATED_IN_MAX_PLY)
               {
@@ -598,13 +909,13 @@ void Thread::search() {
                   Partner.weDead = false;
               }
               // We win by force, so partner should sit
-              else if (!Partner.weWin && bestValue >= VALUE_MATE_IN_MAX_PLY && Limits.time[~us] < Partner.time)
+              else if (!Partner.weWin && bestValue >= VALUE_MATE_IN_MAX_PLY && pool.limits.time[~us] < Partner.time)
               {
                   Partner.ptell("sit");
                   Partner.weWin = true;
               }
               // We are no longer winning
-              else if (Partner.weWin && (bestValue < VALUE_MATE_IN_MAX_PLY || Limits.time[~us] > Partner.time))
+              else if (Partner.weWin && (bestValue < VALUE_MATE_IN_MAX_PLY || pool.limits.time[~us] > Partner.time))
               {
                   Partner.ptell("x");
                   Partner.weWin = false;
@@ -613,14 +924,14 @@ void Thread::search() {
               else if (  !Partner.weVirtualWin
                        && bestValue >= VALUE_VIRTUAL_MATE_IN_MAX_PLY
                        && bestValue <= VALUE_VIRTUAL_MATE
-                       && Limits.time[us] - Time.elapsed() > Partner.opptime)
+                       && pool.limits.time[us] - pool.time.elapsed() > Partner.opptime)
               {
                   Partner.ptell("fast");
                   Partner.weVirtualWin = true;
               }
               // Virtual mate is gone
               else if (   Partner.weVirtualWin
-                       && (bestValue < VALUE_VIRTUAL_MATE_IN_MAX_PLY || bestValue > VALUE_VIRTUAL_MATE || Limits.time[us] - Time.elapsed() < Partner.opptime))
+                       && (bestValue < VALUE_VIRTUAL_MATE_IN_MAX_PLY || bestValue > VALUE_VIRTUAL_MATE || pool.limits.time[us] - pool.time.elapsed() < Partner.opptime))
               {
                   Partner.ptell("slow");
                   Partner.weVirtualWin = false;
@@ -628,7 +939,7 @@ void Thread::search() {
               // We need to survive a virtual mate and play fast
               else if (  !Partner.weVirtualLoss
                        && (bestValue <= -VALUE_VIRTUAL_MATE_IN_MAX_PLY && bestValue >= -VALUE_VIRTUAL_MATE)
-                       && Limits.time[~us] > Partner.time)
+                       && pool.limits.time[~us] > Partner.time)
               {
                   Partner.ptell("sit");
                   Partner.weVirtualLoss = true;
@@ -636,7 +947,7 @@ void Thread::search() {
               }
               // Virtual mate threat is over
               else if (   Partner.weVirtualLoss
-                       && (bestValue > -VALUE_VIRTUAL_MATE_IN_MAX_PLY || bestValue < -VALUE_VIRTUAL_MATE || Limits.time[~us] < Partner.time))
+                       && (bestValue > -VALUE_VIRTUAL_MATE_IN_MAX_PLY || bestValue < -VALUE_VIRTUAL_MATE || pool.limits.time[~us] < Partner.time))
               {
                   Partner.ptell("x");
                   Partner.weVirtualLoss = false;
@@ -645,21 +956,21 @@ void Thread::search() {
           }
 
           // Stop the search if we have exceeded the totalTime
-          if (Time.elapsed() > totalTime)
+          if (pool.time.elapsed() > totalTime)
           {
               // If we are allowed to ponder do not stop the search now but
               // keep pondering until the GUI sends "ponderhit" or "stop".
               if (mainThread->ponder)
                   mainThread->stopOnPonderhit = true;
               else if (!(rootPos.two_boards() && (Partner.sitRequested || Partner.weDead)))
-                  Threads.stop = true;
+                  pool.stop = true;
           }
-          else if (   Threads.increaseDepth
+          else if (   pool.increaseDepth
                    && !mainThread->ponder
-                   && Time.elapsed() > totalTime * 0.58)
-                   Threads.increaseDepth = false;
+                   && pool.time.elapsed() > totalTime * 0.58)
+                   pool.increaseDepth = false;
           else
-                   Threads.increaseDepth = true;
+                   pool.increaseDepth = true;
       }
 
       mainThread->iterValue[iterIdx] = bestValue;
@@ -673,8 +984,8 @@ void Thread::search() {
 
   // If skill level is enabled, swap best PV line with the sub-optimal one
   if (skill.enabled())
-      std::swap(rootMoves[0], *std::find(rootMoves.begin(), rootMoves.end(),
-                skill.best ? skill.best : skill.pick_best(multiPV)));
+      std::swap(rootLines[0], *std::find(rootLines.begin(), rootLines.end(),
+                skill.best ? skill.best : skill.pick_best(rootLines, multiPV)));
 }
 
 
@@ -737,7 +1048,7 @@ namespace {
     maxValue           = VALUE_INFINITE;
 
     // Check for the available remaining time
-    if (thisThread == Threads.main())
+    if (thisThread == thisThread->pool.main())
         static_cast<MainThread*>(thisThread)->check_time();
 
     // Used to send selDepth info to GUI (selDepth counts from 1, ply from 0)
@@ -751,7 +1062,7 @@ namespace {
             return variantResult;
 
         // Step 2. Check for aborted search and immediate draw
-        if (   Threads.stop.load(std::memory_order_relaxed)
+        if (   thisThread->pool.stop.load(std::memory_order_relaxed)
             || ss->ply >= MAX_PLY)
             return (ss->ply >= MAX_PLY && !ss->inCheck) ? evaluate(pos)
                                                         : value_draw(pos.this_thread());
@@ -789,10 +1100,12 @@ namespace {
     // position key in case of an excluded move.
     excludedMove = ss->excludedMove;
     posKey = excludedMove == MOVE_NONE ? pos.key() : pos.key() ^ make_key(excludedMove);
-    tte = TT.probe(posKey, ss->ttHit);
+    tte = thisThread->ttCache.enabled(depth) ? thisThread->ttCache.probe(posKey, ss->ttHit, depth)
+                                             : thisThread->pool.tt.probe(posKey, ss->ttHit);
+    STATS(thisThread->stats.tt_probe(depth, ss->ttHit));
     ttValue = ss->ttHit ? value_from_tt(tte->value(), ss->ply, pos.rule50_count()) : VALUE_NONE;
-    ttMove =  rootNode ? thisThread->rootMoves[thisThread->pvIdx].pv[0]
-            : ss->ttHit    ? tte->move() : MOVE_NONE;
+    ttMove =  rootNode ? thisThread->rootLines[thisThread->pvIdx].move()
+            : ss->ttHit    ? tte->move(pos) : MOVE_NONE;
     if (!excludedMove)
         ss->ttPv = PvNode || (ss->ttHit && tte->is_pv());
 
@@ -861,7 +1174,7 @@ namespace {
             TB::WDLScore wdl = Tablebases::probe_wdl(pos, &err);
 
             // Force check of time on the next occasion
-            if (thisThread == Threads.main())
+            if (thisThread == thisThread->pool.main())
                 static_cast<MainThread*>(thisThread)->callsCnt = 0;
 
             if (err != TB::ProbeState::FAIL)
@@ -883,7 +1196,7 @@ namespace {
                 {
                     tte->save(posKey, value_to_tt(value, ss->ply), ss->ttPv, b,
                               std::min(MAX_PLY - 1, depth + 6),
-                              MOVE_NONE, VALUE_NONE);
+                              MOVE_NONE, VALUE_NONE, pos);
 
                     return value;
                 }
@@ -935,7 +1248,7 @@ namespace {
             ss->staticEval = eval = -(ss-1)->staticEval;
 
         // Save static evaluation into transposition table
-        tte->save(posKey, VALUE_NONE, ss->ttPv, BOUND_NONE, DEPTH_NONE, MOVE_NONE, eval);
+        tte->save(posKey, VALUE_NONE, ss->ttPv, BOUND_NONE, DEPTH_NONE, MOVE_NONE, eval, pos);
     }
 
     // Use static evaluation difference to improve quiet move ordering
@@ -1075,7 +1388,7 @@ namespace {
                        && ttValue != VALUE_NONE))
                         tte->save(posKey, value_to_tt(value, ss->ply), ttPv,
                             BOUND_LOWER,
-                            depth - 3, move, ss->staticEval);
+                            depth - 3, move, ss->staticEval, pos);
                     return value;
                 }
             }
@@ -1147,8 +1460,8 @@ moves_loop: // When in check, search starts from here
       // Move List. As a consequence any illegal move is also skipped. In MultiPV
       // mode we also skip PV moves which have been already searched and those
       // of lower "TB rank" if we are in a TB root position.
-      if (rootNode && !std::count(thisThread->rootMoves.begin() + thisThread->pvIdx,
-                                  thisThread->rootMoves.begin() + thisThread->pvLast, move))
+      if (rootNode && !std::count(thisThread->rootLines.begin() + thisThread->pvIdx,
+                                  thisThread->rootLines.begin() + thisThread->pvLast, move))
           continue;
 
       // Check for legality
@@ -1306,6 +1619,8 @@ moves_loop: // When in check, search starts from here
                                                                 [history_slot(movedPiece)]
                                                                 [to_sq(move)];
 
+      uint64_t nodeCount = rootNode ? uint64_t(thisThread->nodes) : 0;
+
       // Step 15. Make the move
     //   sync_cout << "DEBUG: info depth " << depth
     //       << " do_move " << UCI::move(pos, move) << sync_endl;
@@ -1427,20 +1742,22 @@ moves_loop: // When in check, search starts from here
       // Finished searching the move. If a stop occurred, the return value of
       // the search cannot be trusted, and we return immediately without
       // updating best move, PV and TT.
-      if (Threads.stop.load(std::memory_order_relaxed))
+      if (thisThread->pool.stop.load(std::memory_order_relaxed))
           return VALUE_ZERO;
 
       if (rootNode)
       {
-          RootMove& rm = *std::find(thisThread->rootMoves.begin(),
-                                    thisThread->rootMoves.end(), move);
+          RootLine& rm = *std::find(thisThread->rootLines.begin(),
+                                    thisThread->rootLines.end(), move);
+
+          rm.effort += thisThread->nodes - nodeCount;
 
           // PV move or new best move?
           if (moveCount == 1 || value > alpha)
           {
               rm.score = value;
               rm.selDepth = thisThread->selDepth;
-              rm.pv.resize(1);
+              rm.pv.assign(1, move);
 
               assert((ss+1)->pv);
 
@@ -1475,6 +1792,7 @@ moves_loop: // When in check, search starts from here
               else
               {
                   assert(value >= beta); // Fail high
+                  STATS(++thisThread->stats.cutoffs[mp.current_stage()]);
                   break;
               }
           }
@@ -1491,6 +1809,8 @@ moves_loop: // When in check, search starts from here
       }
     }
 
+    STATS(thisThread->stats.node(mp.generated_moves(), moveCount));
+
     // The following condition would detect a stop only after move loop has been
     // completed. But in this case bestValue is valid because we have fully
     // searched our subtree, and we can anyhow save the result in TT.
@@ -1538,7 +1858,7 @@ moves_loop: // When in check, search starts from here
         tte->save(posKey, value_to_tt(bestValue, ss->ply), ss->ttPv,
                   bestValue >= beta ? BOUND_LOWER :
                   PvNode && bestMove ? BOUND_EXACT : BOUND_UPPER,
-                  depth, bestMove, ss->staticEval);
+                  depth, bestMove, ss->staticEval, pos);
 
     assert(bestValue > -VALUE_INFINITE && bestValue < VALUE_INFINITE);
 
@@ -1599,9 +1919,11 @@ moves_loop: // When in check, search starts from here
                                                   : DEPTH_QS_NO_CHECKS;
     // Transposition table lookup
     posKey = pos.key();
-    tte = TT.probe(posKey, ss->ttHit);
+    tte = thisThread->ttCache.enabled(depth) ? thisThread->ttCache.probe(posKey, ss->ttHit, depth)
+                                             : thisThread->pool.tt.probe(posKey, ss->ttHit);
+    STATS(thisThread->stats.tt_probe(depth, ss->ttHit));
     ttValue = ss->ttHit ? value_from_tt(tte->value(), ss->ply, pos.rule50_count()) : VALUE_NONE;
-    ttMove = ss->ttHit ? tte->move() : MOVE_NONE;
+    ttMove = ss->ttHit ? tte->move(pos) : MOVE_NONE;
     pvHit = ss->ttHit && tte->is_pv();
 
     if (  !PvNode
@@ -1644,7 +1966,7 @@ moves_loop: // When in check, search starts from here
             // Save gathered info in transposition table
             if (!ss->ttHit)
                 tte->save(posKey, value_to_tt(bestValue, ss->ply), false, BOUND_LOWER,
-                          DEPTH_NONE, MOVE_NONE, ss->staticEval);
+                          DEPTH_NONE, MOVE_NONE, ss->staticEval, pos);
 
             return bestValue;
         }
@@ -1713,7 +2035,7 @@ moves_loop: // When in check, search starts from here
           continue;
 
       // Speculative prefetch as early as possible
-      prefetch(TT.first_entry(pos.key_after(move)));
+      prefetch(pos.this_thread()->pool.tt.first_entry(pos.key_after(move)));
 
       // Check for legality just before making the move
       if (!pos.legal(move))
@@ -1757,11 +2079,16 @@ moves_loop: // When in check, search starts from here
               if (PvNode && value < beta) // Update alpha here!
                   alpha = value;
               else
+              {
+                  STATS(++thisThread->stats.cutoffs[mp.current_stage()]);
                   break; // Fail high
+              }
           }
        }
     }
 
+    STATS(thisThread->stats.node(mp.generated_moves(), moveCount));
+
     // All legal moves have been searched. A special case: if we're in check
     // and no legal moves were found, it is checkmate.
     if (ss->inCheck && bestValue == -VALUE_INFINITE)
@@ -1775,7 +2102,7 @@ moves_loop: // When in check, search starts from here
     tte->save(posKey, value_to_tt(bestValue, ss->ply), pvHit,
               bestValue >= beta ? BOUND_LOWER :
               PvNode && bestValue > oldAlpha  ? BOUND_EXACT : BOUND_UPPER,
-              ttDepth, bestMove, ss->staticEval);
+              ttDepth, bestMove, ss->staticEval, pos);
 
     assert(bestValue > -VALUE_INFINITE && bestValue < VALUE_INFINITE);
 
@@ -1945,17 +2272,16 @@ moves_loop: // When in check, search starts from here
         thisThread->lowPlyHistory[ss->ply][from_to(move)] << stat_bonus(depth - 7);
   }
 
-  // When playing with strength handicap, choose best move among a set of RootMoves
+  // When playing with strength handicap, choose best move among a set of RootLines
   // using a statistical rule dependent on 'level'. Idea by Heinz van Saanen.
 
-  Move Skill::pick_best(size_t multiPV) {
+  Move Skill::pick_best(const RootLines& rootLines, size_t multiPV) {
 
-    const RootMoves& rootMoves = Threads.main()->rootMoves;
-    static PRNG rng(now()); // PRNG sequence should be non-deterministic
+    thread_local PRNG rng(now()); // PRNG sequence should be non-deterministic
 
-    // RootMoves are already sorted by score in descending order
-    Value topScore = rootMoves[0].score;
-    int delta = std::min(topScore - rootMoves[multiPV - 1].score, PawnValueMg);
+    // RootLines are already sorted by score in descending order
+    Value topScore = rootLines[0].score;
+    int delta = std::min(topScore - rootLines[multiPV - 1].score, PawnValueMg);
     int weakness = 120 - 2 * level;
     int maxScore = -VALUE_INFINITE;
 
@@ -1965,13 +2291,13 @@ moves_loop: // When in check, search starts from here
     for (size_t i = 0; i < multiPV; ++i)
     {
         // This is our magic formula
-        int push = (  weakness * int(topScore - rootMoves[i].score)
+        int push = (  weakness * int(topScore - rootLines[i].score)
                     + delta * (rng.rand<unsigned>() % weakness)) / 128;
 
-        if (rootMoves[i].score + push >= maxScore)
+        if (rootLines[i].score + push >= maxScore)
         {
-            maxScore = rootMoves[i].score + push;
-            best = rootMoves[i].pv[0];
+            maxScore = rootLines[i].score + push;
+            best = rootLines[i].move();
         }
     }
 
@@ -1990,14 +2316,14 @@ void MainThread::check_time() {
       return;
 
   // When using nodes, ensure checking rate is not lower than 0.1% of nodes
-  callsCnt = Limits.nodes ? std::min(1024, int(Limits.nodes / 1024)) : 1024;
+  callsCnt = pool.limits.nodes ? std::min(1024, int(pool.limits.nodes / 1024)) : 1024;
 
   static TimePoint lastInfoTime = now();
 
-  TimePoint elapsed = Time.elapsed();
-  TimePoint tick = Limits.startTime + elapsed;
+  TimePoint elapsed = pool.time.elapsed();
+  TimePoint tick = pool.limits.startTime + elapsed;
 
-  if (tick - lastInfoTime >= 1000)
+  if (&pool == &Threads && tick - lastInfoTime >= 1000)
   {
       lastInfoTime = tick;
       dbg_print();
@@ -2008,14 +2334,14 @@ void MainThread::check_time() {
       return;
 
   if (   rootPos.two_boards()
-      && Time.elapsed() < Limits.time[rootPos.side_to_move()] - 1000
+      && pool.time.elapsed() < pool.limits.time[rootPos.side_to_move()] - 1000
       && (Partner.sitRequested || (Partner.weDead && !Partner.partnerDead) || Partner.weVirtualWin))
       return;
 
-  if (   (Limits.use_time_management() && (elapsed > Time.maximum() - 10 || stopOnPonderhit))
-      || (Limits.movetime && elapsed >= Limits.movetime)
-      || (Limits.nodes && Threads.nodes_searched() >= (uint64_t)Limits.nodes))
-      Threads.stop = true;
+  if (   (pool.limits.use_time_management() && (elapsed > pool.time.maximum() - 10 || stopOnPonderhit))
+      || (pool.limits.movetime && elapsed >= pool.limits.movetime)
+      || (pool.limits.nodes && pool.nodes_searched() >= (uint64_t)pool.limits.nodes))
+      pool.stop = true;
 }
 
 
@@ -2025,28 +2351,29 @@ void MainThread::check_time() {
 string UCI::pv(const Position& pos, Depth depth, Value alpha, Value beta) {
 
   std::stringstream ss;
-  TimePoint elapsed = Time.elapsed() + 1;
-  const RootMoves& rootMoves = pos.this_thread()->rootMoves;
+  const ThreadPool& pool = pos.this_thread()->pool;
+  TimePoint elapsed = pool.time.elapsed() + 1;
+  const RootLines& rootLines = pos.this_thread()->rootLines;
   size_t pvIdx = pos.this_thread()->pvIdx;
-  size_t multiPV = std::min((size_t)Options["MultiPV"], rootMoves.size());
-  uint64_t nodesSearched = Threads.nodes_searched();
-  uint64_t tbHits = Threads.tb_hits() + (TB::RootInTB ? rootMoves.size() : 0);
+  size_t multiPV = std::min((size_t)pool.options["MultiPV"], rootLines.size());
+  uint64_t nodesSearched = pool.nodes_searched();
+  uint64_t tbHits = pool.tb_hits() + (TB::RootInTB ? rootLines.size() : 0);
 
   for (size_t i = 0; i < multiPV; ++i)
   {
-      bool updated = rootMoves[i].score != -VALUE_INFINITE;
+      bool updated = rootLines[i].score != -VALUE_INFINITE;
 
       if (depth == 1 && !updated && i > 0)
           continue;
 
       Depth d = updated ? depth : std::max(1, depth - 1);
-      Value v = updated ? rootMoves[i].score : rootMoves[i].previousScore;
+      Value v = updated ? rootLines[i].score : rootLines[i].previousScore;
 
       if (v == -VALUE_INFINITE)
           v = VALUE_ZERO;
 
       bool tb = TB::RootInTB && abs(v) < VALUE_MATE_IN_MAX_PLY;
-      v = tb ? rootMoves[i].tbScore : v;
+      v = tb ? rootLines[i].root->tbScore : v;
 
       if (ss.rdbuf()->in_avail()) // Not at first line
           ss << "\n";
@@ -2057,20 +2384,25 @@ string UCI::pv(const Position& pos, Depth depth, Value alpha, Value beta) {
              << UCI::value(v) << " "
              << elapsed / 10 << " "
              << nodesSearched << " "
-             << rootMoves[i].selDepth << " "
+             << rootLines[i].selDepth << " "
              << nodesSearched * 1000 / elapsed << " "
              << tbHits << "\t";
 
           // Do not print PVs with virtual drops in bughouse variants
+          // A line that was not searched yet has no PV but its move
           if (!pos.two_boards())
-              for (Move m : rootMoves[i].pv)
+          {
+              for (Move m : rootLines[i].pv)
                   ss << " " << UCI::move(pos, m);
+              if (rootLines[i].pv.empty())
+                  ss << " " << UCI::move(pos, rootLines[i].move());
+          }
       }
       else
       {
       ss << "info"
          << " depth "    << d
-         << " seldepth " << rootMoves[i].selDepth
+         << " seldepth " << rootLines[i].selDepth
          << " multipv "  << i + 1
          << " score "    << UCI::value(v);
 
@@ -2084,14 +2416,16 @@ string UCI::pv(const Position& pos, Depth depth, Value alpha, Value beta) {
          << " nps "      << nodesSearched * 1000 / elapsed;
 
       if (elapsed > 1000) // Earlier makes little sense
-          ss << " hashfull " << TT.hashfull();
+          ss << " hashfull " << pool.tt.hashfull();
 
       ss << " tbhits "   << tbHits
          << " time "     << elapsed
          << " pv";
 
-      for (Move m : rootMoves[i].pv)
+      for (Move m : rootLines[i].pv)
           ss << " " << UCI::move(pos, m);
+      if (rootLines[i].pv.empty())
+          ss << " " << UCI::move(pos, rootLines[i].move());
       }
   }
 
@@ -2099,34 +2433,34 @@ string UCI::pv(const Position& pos, Depth depth, Value alpha, Value beta) {
 }
 
 
-/// RootMove::extract_ponder_from_tt() is called in case we have no ponder move
+/// RootLine::extract_ponder_from_tt() is called in case we have no ponder move
 /// before exiting the search, for instance, in case we stop the search during a
 /// fail high at root. We try hard to have a ponder move to return to the GUI,
 /// otherwise in case of 'ponder on' we have nothing to think on.
 
-bool RootMove::extract_ponder_from_tt(Position& pos) {
+bool RootLine::extract_ponder_from_tt(Position& pos) {
 
     StateInfo st;
     ASSERT_ALIGNED(&st, Eval::NNUE::CacheLineSize);
 
     bool ttHit;
 
-    assert(pv.size() == 1);
+    assert(pv.size() <= 1);
 
-    if (pv[0] == MOVE_NONE)
+    if (move() == MOVE_NONE)
         return false;
 
-    pos.do_move(pv[0], st);
-    TTEntry* tte = TT.probe(pos.key(), ttHit);
+    pos.do_move(move(), st);
+    TTEntry* tte = pos.this_thread()->pool.tt.probe(pos.key(), ttHit);
 
     if (ttHit)
     {
-        Move m = tte->move(); // Local copy to be SMP safe
+        Move m = tte->move(pos); // Local copy to be SMP safe
         if (MoveList<LEGAL>(pos).contains(m))
-            pv.push_back(m);
+            pv = { move(), m };
     }
 
-    pos.undo_move(pv[0]);
+    pos.undo_move(move());
     return pv.size() > 1;
 }
 
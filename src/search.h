@@ -28,6 +28,7 @@
 namespace Stockfish {
 
 class Position;
+class TranspositionTable;
 
 namespace Search {
 
@@ -56,29 +57,52 @@ struct Stack {
 };
 
 
-/// RootMove struct is used for moves at the root of the tree. For each root move
-/// we store a score and a PV (really a refutation in the case of moves which
-/// fail low). Score is normally set at -VALUE_INFINITE for all non-pv moves.
+/// RootMove struct is used for the legal moves at the root of the tree. The list
+/// is built and ranked by the tablebases once per search, then shared read-only
+/// by all the threads. It may carry what the previous search left behind for a
+/// move, see seed_root_moves().
 
 struct RootMove {
 
-  explicit RootMove(Move m) : pv(1, m) {}
+  explicit RootMove(Move m) : move(m) {}
+  bool operator==(const Move& m) const { return move == m; }
+
+  Move move;
+  int tbRank = 0;
+  Value tbScore;
+  uint64_t effort = 0;
+  std::vector<Move> pv;
+};
+
+typedef std::vector<RootMove> RootMoves;
+
+
+/// RootLine struct is what a thread knows about one of the shared root moves.
+/// For each of them we store a score and a PV (really a refutation in the case
+/// of moves which fail low). Score is normally set at -VALUE_INFINITE for all
+/// non-pv moves. The PV starts with the move and stays empty until the move
+/// has been searched, so setting up the lines of a thread allocates nothing.
+
+struct RootLine {
+
+  explicit RootLine(const RootMove& rm) : root(&rm), effort(rm.effort), pv(rm.pv) {}
   bool extract_ponder_from_tt(Position& pos);
-  bool operator==(const Move& m) const { return pv[0] == m; }
-  bool operator<(const RootMove& m) const { // Sort in descending order
-    return m.score != score ? m.score < score
-                            : m.previousScore < previousScore;
+  Move move() const { return root->move; }
+  bool operator==(const Move& m) const { return root->move == m; }
+  bool operator<(const RootLine& l) const { // Sort in descending order
+    return l.score != score ? l.score < score
+                            : l.previousScore < previousScore;
   }
 
+  const RootMove* root;
   Value score = -VALUE_INFINITE;
   Value previousScore = -VALUE_INFINITE;
   int selDepth = 0;
-  int tbRank = 0;
-  Value tbScore;
+  uint64_t effort;
   std::vector<Move> pv;
 };
 
-typedef std::vector<RootMove> RootMoves;
+typedef std::vector<RootLine> RootLines;
 
 
 /// LimitsType struct stores information sent by GUI about available time to
@@ -106,6 +130,8 @@ extern LimitsType Limits;
 
 void init();
 void clear();
+void seed_root_moves(Position& pos, RootMoves& rootMoves, const RootLines& previous, Key previousKey,
+                     const TranspositionTable& tt);
 
 } // namespace Search
 
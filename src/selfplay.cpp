@@ -0,0 +1,1045 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2022 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mcts.h"
+#include "misc.h"
+#include "movegen.h"
+#include "position.h"
+#include "search.h"
+#include "selfplay.h"
+#include "thread.h"
+#include "timeman.h"
+#include "tt.h"
+#include "uci.h"
+
+namespace Stockfish {
+
+namespace {
+
+  // Games longer than this are adjudicated as draws
+  constexpr int MaxGamePly = 400;
+
+  // A training position as written by "generate_training_data". The board
+  // holds 4 bits per square, the squares of the variant board in rank-major
+  // order starting from a1: 0 for an empty square, else the piece type index
+  // in the variant (1 for the architect, 2-4 for house, palace and tower)
+  // plus 8 for black. The pieces in hand follow from the board. The score is
+  // the search score for the side to move, in internal units, and the result
+  // is the game result for the side to move: 1, 0 or -1.
+  struct PackedPosition {
+    uint8_t board[41];
+    uint8_t sideToMove;
+    int16_t score;
+    int8_t result;
+    uint8_t padding;
+    uint16_t gamePly;
+  };
+
+  static_assert(sizeof(PackedPosition) == 48, "Unexpected PackedPosition size");
+
+  PackedPosition pack(const Position& pos, Value score) {
+
+    PackedPosition p = {};
+    int i = 0;
+
+    for (Rank r = RANK_1; r <= pos.max_rank(); ++r)
+        for (File f = FILE_A; f <= pos.max_file(); ++f, ++i)
+        {
+            Piece pc = pos.piece_on(make_square(f, r));
+            if (pc != NO_PIECE)
+                p.board[i / 2] |= uint8_t(  (type_of(pc) - CUSTOM_PIECE_1 + 1 + 8 * color_of(pc))
+                                          << (4 * (i & 1)));
+        }
+
+    p.sideToMove = uint8_t(pos.side_to_move());
+    p.score = int16_t(std::clamp(int(score), -32000, 32000));
+    p.gamePly = uint16_t(pos.game_ply());
+    return p;
+  }
+
+  // ShardWriter appends the positions of finished games to numbered files of
+  // at most shardSize positions each: <prefix>_0.bin, <prefix>_1.bin, ...
+  class ShardWriter {
+
+  public:
+    ShardWriter(const std::string& p, uint64_t size) : prefix(p), shardSize(size) {}
+
+    bool write(const std::vector<PackedPosition>& positions) {
+
+      for (const PackedPosition& p : positions)
+      {
+          if (!out.is_open() || inShard == shardSize)
+          {
+              out.close();
+              out.open(prefix + "_" + std::to_string(shard++) + ".bin", std::ios::binary);
+              inShard = 0;
+          }
+
+          out.write(reinterpret_cast<const char*>(&p), sizeof(p));
+          ++inShard;
+      }
+
+      out.flush();
+      return bool(out);
+    }
+
+    uint64_t shards() const { return shard; }
+
+  private:
+    std::ofstream out;
+    std::string prefix;
+    uint64_t shardSize, inShard = 0, shard = 0;
+  };
+
+  // random_opening() plays the given number of random legal moves, fewer if
+  // the game ends first, and returns them
+  std::vector<Move> random_opening(Position& pos, StateListPtr& states, int plies, PRNG& rng) {
+
+    std::vector<Move> moves;
+    Value result;
+
+    for (int ply = 0; ply < plies && !pos.is_game_end(result); ++ply)
+    {
+        MoveList<LEGAL> legal(pos);
+        if (!legal.size())
+            break;
+
+        moves.push_back(*(legal.begin() + rng.rand<uint64_t>() % legal.size()));
+        states->emplace_back();
+        pos.do_move(moves.back(), states->back());
+    }
+
+    return moves;
+  }
+
+  // The options that a pool keeps, see ThreadPool::options. Each player of a
+  // match has its own values of them and of the TUNABLE parameters, the
+  // other options are global.
+  const std::set<std::string, UCI::CaseInsensitiveLess> PoolOptions = {
+    "Skill Level", "UCI_Elo", "UCI_LimitStrength", "MultiPV",
+    "Keep Search State", "Move Overhead", "Slow Mover", "nodestime"
+  };
+
+  bool global_option(const std::string& name) {
+    return !PoolOptions.count(name) && !Tune::is_tunable(name);
+  }
+
+  // Engine is a private search instance for the games that run side by side:
+  // a thread pool of one thread with its own hash table, histories, time
+  // manager, limits, pool options and TUNABLE values, so that nothing leaks
+  // between the games or between the players of a game. Its searches print
+  // nothing.
+  class Engine {
+
+  public:
+    Engine(size_t hashMB, const std::vector<std::pair<std::string, std::string>>& opts) : options(Options) {
+
+      for (const auto& [name, value] : opts)
+          if (PoolOptions.count(name))
+              options[name] = value;
+
+      tunables = Tune::values(opts);
+      pool.tunables = tunables.data();
+      pool.set(1);
+      tt.resize(hashMB);
+    }
+
+   ~Engine() { pool.set(0); }
+
+    Thread* thread() const { return pool.main(); }
+    uint64_t nodes_searched() const { return pool.nodes_searched(); }
+
+    // new_game() clears the hash table and the histories
+    void new_game() {
+      tt.clear(1);
+      time.availableNodes = 0;
+      pool.clear();
+    }
+
+    // think() searches pos under the given limits. The states of the game
+    // are lent to the pool for the search and then given back. Returns the
+    // score for the side to move and the best move in bestMove.
+    Value think(Position& pos, StateListPtr& states, const Search::LimitsType& searchLimits, Move& bestMove) {
+
+      pool.start_thinking(pos, states, searchLimits);
+      pool.main()->wait_for_search_finished();
+      states = std::move(pool.setupStates);
+
+      const Search::RootLine& rl = pool.main()->bestThread->rootLines[0];
+      bestMove = rl.move();
+      return rl.score != -VALUE_INFINITE ? rl.score : rl.previousScore;
+    }
+
+  private:
+    TranspositionTable tt;
+    TimeManagement time;
+    Search::LimitsType limits;
+    UCI::OptionsMap options;
+    std::vector<int> tunables;
+    ThreadPool pool{tt, time, limits, options};
+  };
+
+  // side_by_side() tells whether the games of a selfplay command can run side
+  // by side in the given position, else reports why not. The MCTS tree and
+  // the partner of the two-board variants are global.
+  bool side_by_side(const Position& pos, const std::string& command) {
+
+    if (MCTS::enabled())
+        sync_cout << "info string " << command << " does not support the MCTS search mode" << sync_endl;
+    else if (pos.two_boards())
+        sync_cout << "info string " << command << " does not support two-board variants" << sync_endl;
+    else
+        return true;
+
+    return false;
+  }
+
+  // Search limits of a player
+  struct Limits {
+    Depth depth = 0;        // Maximum depth, or 0 for no limit
+    int64_t nodes = 0;      // Maximum number of nodes, or 0 for no limit
+    TimePoint movetime = 0; // Time per move in ms, or 0 for no limit
+    TimePoint time = 0;     // Time per game in ms for a time control, or 0
+    TimePoint inc = 0;      // Increment per move in ms
+  };
+
+  // A player of a match: its search limits, the size of its hash table and
+  // its UCI options, as name and value. The pool options and TUNABLE values
+  // go to the engines of the player, the global options are set before each
+  // of its moves.
+  struct Player {
+    Limits limits;
+    size_t hash = 0; // In MB, or 0 for the Hash option
+    std::vector<std::pair<std::string, std::string>> options;
+
+    // value() returns the value that the player gives to an option
+    std::string value(const std::string& name) const {
+      std::string v = Options[name];
+      for (const auto& o : options)
+          if (&Options[o.first] == &Options[name])
+              v = o.second;
+      return v;
+    }
+
+    void set_options() const {
+      for (const auto& [name, value] : options)
+          if (global_option(name) && std::string(Options[name]) != value)
+              Options[name] = value;
+    }
+  };
+
+  // play_game() plays the game out from pos, each player with its engine,
+  // setting the global options of each player before its moves. With a time
+  // control, the clock of the side to move is passed to the search and a
+  // side whose clock runs out loses. The function visit(pos, score) is
+  // called before each move. Returns the result for white: 1, 0 or -1.
+  template<typename Visit>
+  int play_game(Position& pos, StateListPtr& states, const Player* players[COLOR_NB],
+                Engine* engines[COLOR_NB], Visit visit) {
+
+    TimePoint clock[COLOR_NB] = { players[WHITE]->limits.time, players[BLACK]->limits.time };
+    Value result = VALUE_DRAW;
+
+    while (true)
+    {
+        Color us = pos.side_to_move();
+
+        if (pos.is_game_end(result))
+            break;
+
+        if (!MoveList<LEGAL>(pos).size())
+        {
+            result = pos.checkers() ? pos.checkmate_value() : pos.stalemate_value();
+            break;
+        }
+
+        if (pos.game_ply() >= MaxGamePly)
+        {
+            result = VALUE_DRAW;
+            break;
+        }
+
+        const Limits& l = players[us]->limits;
+        Search::LimitsType limits;
+        limits.depth = l.depth;
+        limits.nodes = l.nodes;
+        limits.movetime = l.movetime;
+        if (l.time)
+        {
+            limits.time[us] = std::max(clock[us], TimePoint(1));
+            limits.inc[us] = l.inc;
+        }
+
+        players[us]->set_options();
+
+        Move best;
+        TimePoint start = limits.startTime = now();
+        Value v = engines[us]->think(pos, states, limits, best);
+
+        if (l.time && (clock[us] += l.inc - (now() - start)) < 0)
+            return us == WHITE ? -1 : 1;
+
+        visit(pos, v);
+        states->emplace_back();
+        pos.do_move(best, states->back());
+    }
+
+    if (pos.side_to_move() == BLACK)
+        result = -result;
+
+    return result > VALUE_DRAW ? 1 : result < VALUE_DRAW ? -1 : 0;
+  }
+
+  // play_pair() plays up to two games between two players from the same
+  // opening: the given FEN and some random plies. The first player has the
+  // side to move of the opening in the first game and the other side in the
+  // second game. The engines of the players are cleared before each game.
+  // The function report(result) gets the result of the first player of each
+  // game.
+  template<typename Report>
+  void play_pair(const Position& root, const std::string& fen, int randomPlies, uint64_t seed, int games,
+                 const Player* players[2], Engine* engines[2], Report report) {
+
+    PRNG rng(seed);
+    std::vector<Move> opening;
+
+    for (int game = 0; game < games; ++game)
+    {
+        StateListPtr states(new std::deque<StateInfo>(1));
+        Position pos;
+        pos.set(root.variant(), fen, root.is_chess960(), &states->back(), engines[0]->thread());
+
+        if (game == 0)
+            opening = random_opening(pos, states, randomPlies, rng);
+        else
+            for (Move m : opening)
+            {
+                states->emplace_back();
+                pos.do_move(m, states->back());
+            }
+
+        Color firstColor = game == 0 ? pos.side_to_move() : ~pos.side_to_move();
+        const Player* sides[COLOR_NB];
+        Engine* sideEngines[COLOR_NB];
+        sides[firstColor] = players[0];
+        sides[~firstColor] = players[1];
+        sideEngines[firstColor] = engines[0];
+        sideEngines[~firstColor] = engines[1];
+
+        engines[0]->new_game();
+        engines[1]->new_game();
+        int result = play_game(pos, states, sides, sideEngines, [](const Position&, Value) {});
+        report(firstColor == WHITE ? result : -result);
+    }
+  }
+
+  // play_pairs() plays game pairs between two players side by side, one pair
+  // at a time on each of the given number of workers, and each worker with
+  // an engine for each player. Pair n starts from the FEN fens[n % size] and
+  // uses the seed seed + n for its random plies. The function report(result)
+  // gets the result of the first player of each game, one call at a time,
+  // and returns false to stop the workers after their current pair.
+  template<typename Report>
+  void play_pairs(const Position& root, const std::vector<std::string>& fens, int randomPlies,
+                  int64_t games, uint64_t seed, const Player* players[2], size_t workerCount, Report report) {
+
+    std::atomic<int64_t> next(0);
+    std::atomic<bool> stop(false);
+    std::mutex mutex;
+    std::vector<std::thread> workers;
+
+    for (size_t idx = 0; idx < workerCount; ++idx)
+        workers.emplace_back([&]() {
+            Engine first(players[0]->hash ? players[0]->hash : size_t(Options["Hash"]), players[0]->options);
+            Engine second(players[1]->hash ? players[1]->hash : size_t(Options["Hash"]), players[1]->options);
+            Engine* engines[2] = { &first, &second };
+
+            for (int64_t pair; !stop && (pair = next++) * 2 < games; )
+                play_pair(root, fens[size_t(pair) % fens.size()], randomPlies, seed + uint64_t(pair),
+                          int(std::min(games - pair * 2, int64_t(2))), players, engines,
+                          [&](int result) {
+                              std::lock_guard<std::mutex> lk(mutex);
+                              if (!report(result))
+                                  stop = true;
+                          });
+        });
+
+    for (std::thread& w : workers)
+        w.join();
+  }
+
+  // MatchGuard restores the values of the global options that the given
+  // players set
+  struct MatchGuard {
+    explicit MatchGuard(const std::vector<const Player*>& players) {
+      for (const Player* p : players)
+          for (const auto& o : p->options)
+              if (global_option(o.first))
+                  saved.emplace_back(o.first, std::string(Options[o.first]));
+    }
+
+    ~MatchGuard() {
+      for (const auto& [name, value] : saved)
+          if (std::string(Options[name]) != value)
+              Options[name] = value;
+    }
+
+  private:
+    std::vector<std::pair<std::string, std::string>> saved;
+  };
+
+  // Statistics of a match from the point of view of the first player
+  struct MatchStats {
+    int64_t wins, losses, draws;
+
+    int64_t games() const { return wins + losses + draws; }
+
+    double score() const { return (wins + draws / 2.0) / games(); }
+
+    // Variance of the result of one game
+    double variance() const {
+      double s = score();
+      return (  wins * (1 - s) * (1 - s) + losses * s * s
+              + draws * (0.5 - s) * (0.5 - s)) / games();
+    }
+
+    static double elo(double s) {
+      s = std::clamp(s, 1e-6, 1 - 1e-6);
+      return 400 * std::log10(s / (1 - s));
+    }
+
+    // Elo difference and its 95% confidence margin
+    double elo() const { return elo(score()); }
+    double margin() const {
+      double dev = 1.96 * std::sqrt(variance() / games());
+      return (elo(score() + dev) - elo(score() - dev)) / 2;
+    }
+
+    // Log-likelihood ratio of the hypotheses elo1 against elo0, with the
+    // normal approximation of the trinomial distribution of game results
+    double llr(double elo0, double elo1) const {
+      double s0 = 1 / (1 + std::pow(10, -elo0 / 400)), s1 = 1 / (1 + std::pow(10, -elo1 / 400));
+      double var = variance();
+      return var > 0 ? games() * (s1 - s0) * (2 * score() - s0 - s1) / (2 * var) : 0;
+    }
+  };
+
+} // namespace
+
+
+/// generate_training_data() implements the "generate_training_data" command.
+/// Every thread of the pool plays its own games from the current position,
+/// with a private search instance on one thread: a few random moves, then
+/// moves of the search under a depth or node limit. All positions after the
+/// random opening are written with their search score and the final result,
+/// as PackedPosition records. Each thread writes its own shards of shard_size
+/// positions: <prefix>_<thread>_0.bin, <prefix>_<thread>_1.bin, ... Exactly
+/// the requested number of positions is written, the last games are cut short
+/// if needed. The Hash option is split between the threads. Only the 9x9
+/// Urbino board fits a PackedPosition.
+///
+/// Usage: generate_training_data [depth N] [nodes N] [positions N]
+///                               [random_plies N] [shard_size N] [output prefix]
+
+void SelfPlay::generate_training_data(const Position& root, std::istream& is) {
+
+  Search::LimitsType limits;
+  int64_t positions = 100000, shardSize = 1000000;
+  int randomPlies = 6;
+  std::string token, prefix = "training_data";
+
+  while (is >> token)
+      if (token == "depth")             is >> limits.depth;
+      else if (token == "nodes")        is >> limits.nodes;
+      else if (token == "positions")    is >> positions;
+      else if (token == "random_plies") is >> randomPlies;
+      else if (token == "shard_size")   is >> shardSize;
+      else if (token == "output")       is >> prefix;
+
+  if (!root.urbino_gating())
+  {
+      sync_cout << "info string generate_training_data is only supported in Urbino" << sync_endl;
+      return;
+  }
+
+  if (root.max_file() != FILE_I || root.max_rank() != RANK_9)
+  {
+      sync_cout << "info string generate_training_data needs a 9x9 board" << sync_endl;
+      return;
+  }
+
+  if (!side_by_side(root, "generate_training_data"))
+      return;
+
+  if (!limits.depth && !limits.nodes)
+      limits.depth = 4;
+
+  Threads.main()->wait_for_search_finished();
+
+  const size_t workerCount = Threads.size();
+  const size_t hashMB = std::max(size_t(Options["Hash"]) / workerCount, size_t(1));
+  const std::string fen = root.fen();
+  const uint64_t seed = now();
+  std::atomic<int64_t> reserved(0), written(0), games(0), nodes(0), shards(0);
+  std::atomic<bool> failed(false);
+  std::vector<std::thread> workers;
+  TimePoint elapsed = now();
+
+  for (size_t idx = 0; idx < workerCount; ++idx)
+      workers.emplace_back([&, idx]() {
+          Engine engine(hashMB, {});
+          ShardWriter writer(prefix + "_" + std::to_string(idx), uint64_t(std::max(shardSize, int64_t(1))));
+          Search::LimitsType l = limits;
+          PRNG rng(seed ^ (1070372 * (idx + 1)));
+
+          while (reserved < positions && !failed)
+          {
+              StateListPtr states(new std::deque<StateInfo>(1));
+              Position pos;
+              pos.set(root.variant(), fen, root.is_chess960(), &states->back(), engine.thread());
+
+              std::vector<PackedPosition> game;
+              Value result = VALUE_DRAW;
+
+              engine.new_game();
+              random_opening(pos, states, randomPlies, rng);
+
+              // Play the game out with the search
+              while (!pos.is_game_end(result))
+              {
+                  if (!MoveList<LEGAL>(pos).size())
+                  {
+                      result = pos.checkers() ? pos.checkmate_value() : pos.stalemate_value();
+                      break;
+                  }
+
+                  if (pos.game_ply() >= MaxGamePly)
+                  {
+                      result = VALUE_DRAW;
+                      break;
+                  }
+
+                  Move best;
+                  l.startTime = now();
+                  Value v = engine.think(pos, states, l, best);
+                  nodes += engine.nodes_searched();
+
+                  game.push_back(pack(pos, v));
+                  states->emplace_back();
+                  pos.do_move(best, states->back());
+              }
+
+              // Store the results from the point of view of each position
+              Color winner = result > VALUE_DRAW ? pos.side_to_move() : ~pos.side_to_move();
+              for (PackedPosition& p : game)
+                  p.result = int8_t(result == VALUE_DRAW ? 0 : p.sideToMove == winner ? 1 : -1);
+
+              // Take the positions of the game that still fit in the total
+              int64_t first = reserved.fetch_add(int64_t(game.size()));
+              if (first >= positions)
+                  break;
+
+              game.resize(size_t(std::min(int64_t(game.size()), positions - first)));
+
+              if (!writer.write(game))
+                  failed = true;
+
+              written += game.size();
+              ++games;
+          }
+
+          shards += writer.shards();
+      });
+
+  // Report the progress while the workers run
+  for (TimePoint last = now(); reserved < positions && !failed; )
+  {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      if (now() - last >= 10000)
+      {
+          last = now();
+          sync_cout << "info string " << written << " positions of " << games << " games, "
+                    << written * 1000 / (now() - elapsed + 1) << " positions/s" << sync_endl;
+      }
+  }
+
+  for (std::thread& w : workers)
+      w.join();
+
+  elapsed = now() - elapsed + 1;
+
+  sync_cout << "info string " << (failed ? "Could not write training data, " : "Generated ")
+            << written << " positions of " << games << " games in " << shards
+            << " shards " << prefix << "_*.bin, " << written * 1000 / elapsed << " positions/s, "
+            << nodes * 1000 / elapsed << " nps" << sync_endl;
+}
+
+
+/// match() implements the "selfplay" command. It plays games between two
+/// players with their own search limits, time control, hash size and UCI
+/// options. Every thread of the pool plays its own game pairs, with a private
+/// search instance of one thread for each player, so the players share no
+/// hash table or histories. The options that a pool keeps, see
+/// ThreadPool::options, can differ between the players. The other options
+/// are global, so the players must agree on them, and they are set for the
+/// match and restored at the end. Games come in pairs with the same opening
+/// and swapped colors. Openings are read from a file with one FEN per line,
+/// else they are random moves from the current position. The Elo difference
+/// of the first player is reported while the match runs, and with an SPRT
+/// the match stops as soon as one of the hypotheses is accepted.
+///
+/// Usage: selfplay [games N] [openings file] [random_plies N]
+///                 [sprt elo0 elo1] [alpha a] [beta b]
+///                 first <player> second <player>
+/// where <player> is any of: depth N, nodes N, movetime ms, tc base+inc (in
+/// seconds), hash MB, option name <name> value <value>
+
+void SelfPlay::match(const Position& root, std::istream& is) {
+
+  Player players[2];
+  int64_t maxGames = 100;
+  int randomPlies = 6;
+  double elo0 = 0, elo1 = 5, alpha = 0.05, beta = 0.05;
+  bool sprt = false;
+  std::string token, openingFile;
+  std::vector<std::string> openings;
+  int player = 0;
+
+  while (is >> token)
+      if (token == "games")             is >> maxGames;
+      else if (token == "openings")     is >> openingFile;
+      else if (token == "random_plies") is >> randomPlies;
+      else if (token == "sprt")         sprt = bool(is >> elo0 >> elo1);
+      else if (token == "alpha")        is >> alpha;
+      else if (token == "beta")         is >> beta;
+      else if (token == "first")        player = 0;
+      else if (token == "second")       player = 1;
+      else if (token == "depth")        is >> players[player].limits.depth;
+      else if (token == "nodes")        is >> players[player].limits.nodes;
+      else if (token == "movetime")     is >> players[player].limits.movetime;
+      else if (token == "hash")         is >> players[player].hash;
+      else if (token == "tc")
+      {
+          double base = 0, inc = 0;
+          char sep;
+          is >> base;
+          if (is.peek() == '+')
+              is >> sep >> inc;
+          players[player].limits.time = TimePoint(base * 1000);
+          players[player].limits.inc = TimePoint(inc * 1000);
+      }
+      else if (token == "option")
+      {
+          // Read the option name, which can contain spaces, and its value
+          std::string name, value;
+          is >> token; // Consume the "name" token
+          while (is >> token && token != "value")
+              name += (name.empty() ? "" : " ") + token;
+          is >> value;
+
+          if (!Options.count(name))
+          {
+              sync_cout << "info string No such option: " << name << sync_endl;
+              return;
+          }
+
+          // The games make their own thread pools and hash tables
+          if (&Options[name] == &Options["Threads"])
+          {
+              sync_cout << "info string Threads must be set before the match" << sync_endl;
+              return;
+          }
+
+          if (&Options[name] == &Options["Hash"])
+              std::istringstream(value) >> players[player].hash;
+          else
+              players[player].options.emplace_back(name, value);
+      }
+
+  for (Player& p : players)
+      if (!p.limits.depth && !p.limits.nodes && !p.limits.movetime && !p.limits.time)
+          p.limits.depth = 4;
+
+  // The global options are set once for all games
+  for (const Player& p : players)
+      for (const auto& o : p.options)
+          if (global_option(o.first) && players[0].value(o.first) != players[1].value(o.first))
+          {
+              sync_cout << "info string " << o.first << " must be the same for both players" << sync_endl;
+              return;
+          }
+
+  if (!openingFile.empty())
+  {
+      std::ifstream file(openingFile);
+      for (std::string fen; std::getline(file, fen); )
+          if (!fen.empty())
+              openings.push_back(fen);
+
+      if (openings.empty())
+      {
+          sync_cout << "info string Could not read openings from " << openingFile << sync_endl;
+          return;
+      }
+  }
+
+  if (!side_by_side(root, "selfplay"))
+      return;
+
+  Threads.main()->wait_for_search_finished();
+
+  MatchGuard guard({ &players[0], &players[1] });
+  players[0].set_options();
+
+  const Player* order[2] = { &players[0], &players[1] };
+  const double lower = std::log(beta / (1 - alpha)), upper = std::log((1 - beta) / alpha);
+  MatchStats stats = { 0, 0, 0 };
+  double llr = 0;
+  TimePoint last = now();
+
+  auto report = [&]() {
+      sync_cout << "info string Games " << stats.games() << ": +" << stats.wins << " -" << stats.losses
+                << " =" << stats.draws << " Elo " << std::fixed << std::setprecision(1) << stats.elo()
+                << " +- " << stats.margin();
+      if (sprt)
+          std::cout << " LLR " << std::setprecision(2) << llr << " [" << lower << ", " << upper << "]";
+      std::cout << std::defaultfloat << sync_endl;
+  };
+
+  // Both games of a pair start from the same opening. The results are
+  // reported every 10 seconds, and the match stops once the SPRT has
+  // accepted a hypothesis.
+  play_pairs(root, openings.empty() ? std::vector<std::string>{ root.fen() } : openings,
+             openings.empty() ? randomPlies : 0, maxGames, 1, order, Threads.size(),
+             [&](int result) {
+                 if (llr <= lower || llr >= upper) // Decided, drop the pairs still running
+                     return false;
+
+                 ++(result > 0 ? stats.wins : result < 0 ? stats.losses : stats.draws);
+                 llr = sprt ? stats.llr(elo0, elo1) : 0;
+
+                 if (now() - last >= 10000)
+                 {
+                     last = now();
+                     report();
+                 }
+                 return llr > lower && llr < upper;
+             });
+
+  if (!stats.games())
+      return;
+
+  report();
+
+  if (sprt)
+      sync_cout << "info string SPRT(" << elo0 << ", " << elo1 << "): "
+                << (llr >= upper ? "H1 accepted" : llr <= lower ? "H0 accepted" : "inconclusive")
+                << sync_endl;
+}
+
+
+/// spsa() implements the "spsa" command, an in-process SPSA tuner of the
+/// parameters that have UCI options through TUNE(): the TUNABLE ones in
+/// builds with tune=yes, and any other ones (see tune.h). Each iteration
+/// perturbs all parameters up or down at random, and plays game pairs between
+/// the two perturbed sets, each with a private search instance. The pairs run
+/// side by side on all threads of the pool when all parameters are TUNABLE,
+/// since each search instance has its own values of them. Other parameters
+/// are global, so they are set through their options before each move and
+/// the pairs are played one after the other. The parameters then move towards
+/// the winning set.
+/// Step sizes follow the fishtest defaults: the final perturbation is a
+/// twentieth of the range of the parameter, and the final learning rate is
+/// 0.002. The values are saved to the checkpoint file after each iteration,
+/// and a tuning resumes from the file if it exists. The tuned values are set
+/// as the values of the UCI options of the parameters at the end.
+///
+/// Usage: spsa [iterations N] [pairs N] [depth N] [nodes N] [movetime ms]
+///             [random_plies N] [checkpoint file]
+
+void SelfPlay::spsa(const Position& root, std::istream& is) {
+
+  constexpr double Alpha = 0.602, Gamma = 0.101, REnd = 0.002;
+
+  const std::vector<Tune::Param>& params = Tune::params();
+  Limits limits;
+  int iterations = 100, pairs = 8, randomPlies = 6, first = 0;
+  std::string token, checkpoint = "spsa.txt";
+
+  while (is >> token)
+      if (token == "iterations")        is >> iterations;
+      else if (token == "pairs")        is >> pairs;
+      else if (token == "depth")        is >> limits.depth;
+      else if (token == "nodes")        is >> limits.nodes;
+      else if (token == "movetime")     is >> limits.movetime;
+      else if (token == "random_plies") is >> randomPlies;
+      else if (token == "checkpoint")   is >> checkpoint;
+
+  if (params.empty())
+  {
+      sync_cout << "info string No parameters to tune, add TUNE() parameters or build with tune=yes" << sync_endl;
+      return;
+  }
+
+  if (!limits.depth && !limits.nodes && !limits.movetime)
+      limits.depth = 4;
+
+  pairs = std::max(pairs, 1);
+
+  if (!side_by_side(root, "spsa"))
+      return;
+
+  std::vector<double> theta;
+  for (const auto& p : params)
+      theta.push_back(double(Options[p.name]));
+
+  // Resume from the checkpoint, which holds the next iteration and the
+  // values of the parameters by name
+  std::ifstream in(checkpoint);
+  if (in >> token && token == "iteration" && in >> first)
+  {
+      double value;
+      while (in >> token >> value)
+          for (size_t i = 0; i < params.size(); ++i)
+              if (params[i].name == token)
+                  theta[i] = value;
+  }
+
+  Threads.main()->wait_for_search_finished();
+
+  // The TUNABLE parameters belong to the engines of the players, so their
+  // pairs run side by side. Any other parameter is global and set before
+  // each move, so the pairs are played one after the other.
+  const bool tunable = std::all_of(params.begin(), params.end(),
+                                   [](const Tune::Param& p) { return Tune::is_tunable(p.name); });
+
+  // Game pairs are the SPSA steps, in batches of one iteration
+  const double N = double(iterations) * pairs, A = 0.1 * N;
+  const std::string fen = root.fen();
+  PRNG rng(now());
+  TimePoint elapsed = now(), last = now();
+
+  for (int iter = first; iter < iterations; ++iter)
+  {
+      double k = double(iter) * pairs;
+      std::vector<int> plus, minus;
+      std::vector<double> steps;
+
+      for (size_t i = 0; i < params.size(); ++i)
+      {
+          Range r = params[i].range;
+          double cEnd = std::max((r.second - r.first) / 20.0, 1.0);
+          double c = cEnd * std::pow(N, Gamma) / std::pow(k + 1, Gamma);
+          double a = REnd * cEnd * cEnd * std::pow(A + N, Alpha) / std::pow(A + k + 1, Alpha);
+          double delta = rng.rand<uint64_t>() & 1 ? c : -c;
+
+          plus.push_back(std::clamp(int(std::lround(theta[i] + delta)), r.first, r.second));
+          minus.push_back(std::clamp(int(std::lround(theta[i] - delta)), r.first, r.second));
+          steps.push_back(a / (c * c) * delta);
+      }
+
+      // Play the pairs of the iteration, the first player with the values
+      // perturbed up
+      Player up, down;
+      up.limits = down.limits = limits;
+      for (size_t i = 0; i < params.size(); ++i)
+      {
+          up.options.emplace_back(params[i].name, std::to_string(plus[i]));
+          down.options.emplace_back(params[i].name, std::to_string(minus[i]));
+      }
+
+      const Player* players[2] = { &up, &down };
+      int score = 0;
+
+      play_pairs(root, { fen }, randomPlies, 2 * int64_t(pairs), rng.rand<uint64_t>(), players,
+                 tunable ? Threads.size() : 1,
+                 [&](int result) { score += result; return true; });
+
+      for (size_t i = 0; i < params.size(); ++i)
+          theta[i] = std::clamp(theta[i] + steps[i] * score, double(params[i].range.first),
+                                                              double(params[i].range.second));
+
+      std::ofstream out(checkpoint);
+      out << "iteration " << iter + 1 << "\n";
+      for (size_t i = 0; i < params.size(); ++i)
+          out << params[i].name << " " << theta[i] << "\n";
+
+      if (!out)
+          sync_cout << "info string Could not write checkpoint " << checkpoint << sync_endl;
+
+      if (now() - last >= 10000 || iter + 1 == iterations)
+      {
+          last = now();
+          sync_cout << "info string Iteration " << iter + 1 << " of " << iterations << ", "
+                    << (now() - elapsed) / 1000 << "s";
+          for (size_t i = 0; i < params.size(); ++i)
+              std::cout << ", " << params[i].name << " " << std::fixed << std::setprecision(1) << theta[i];
+          std::cout << std::defaultfloat << sync_endl;
+      }
+  }
+
+  // Set the tuned values
+  for (size_t i = 0; i < params.size(); ++i)
+      Options[params[i].name] = std::to_string(std::lround(theta[i]));
+
+  sync_cout << "info string Tuned values:";
+  for (size_t i = 0; i < params.size(); ++i)
+      std::cout << " " << params[i].name << "=" << std::string(Options[params[i].name]);
+  std::cout << sync_endl;
+}
+
+
+/// fuzz() implements the "fuzz" command, a differential test of the fast
+/// Urbino structures. Every thread of the pool plays random games from the
+/// current position and calls Position::urbino_verify() after each move, and
+/// again after each undo while taking the game back. The first difference
+/// stops all threads and is reported with the moves leading to it.
+///
+/// Usage: fuzz [games N] [seed N] [max_plies N]
+
+void SelfPlay::fuzz(const Position& root, std::istream& is) {
+
+  int64_t games = 1000;
+  uint64_t seed = now();
+  int maxPlies = MaxGamePly;
+  std::string token;
+
+  while (is >> token)
+      if (token == "games")          is >> games;
+      else if (token == "seed")      is >> seed;
+      else if (token == "max_plies") is >> maxPlies;
+
+  if (!root.urbino_gating())
+  {
+      sync_cout << "info string fuzz is only supported in Urbino" << sync_endl;
+      return;
+  }
+
+  Threads.main()->wait_for_search_finished();
+
+  std::atomic<int64_t> started(0), played(0), nodes(0);
+  std::atomic<bool> failed(false);
+  std::mutex mutex;
+  std::string failure;
+  const std::string fen = root.fen();
+  std::vector<std::thread> workers;
+  TimePoint elapsed = now();
+
+  for (size_t idx = 0; idx < Threads.size(); ++idx)
+      workers.emplace_back([&, idx]() {
+          Thread* th = Threads[idx];
+          PRNG rng(seed ^ (1070372 * (idx + 1)));
+
+          while (started++ < games && !failed)
+          {
+              StateListPtr states(new std::deque<StateInfo>(1));
+              Position pos;
+              pos.set(root.variant(), fen, root.is_chess960(), &states->back(), th);
+
+              std::vector<Move> moves;
+              std::vector<std::string> game;
+              std::string error = pos.urbino_verify();
+              Value result;
+
+              while (   error.empty() && int(moves.size()) < maxPlies
+                     && !pos.is_game_end(result) && !failed)
+              {
+                  MoveList<LEGAL> legal(pos);
+                  if (!legal.size())
+                      break;
+
+                  moves.push_back(*(legal.begin() + rng.rand<uint64_t>() % legal.size()));
+                  game.push_back(UCI::move(pos, moves.back()));
+                  states->emplace_back();
+                  pos.do_move(moves.back(), states->back());
+                  error = pos.urbino_verify();
+                  ++nodes;
+              }
+
+              // Take the game back, which exercises the undo of the merges
+              while (error.empty() && !moves.empty())
+              {
+                  pos.undo_move(moves.back());
+                  moves.pop_back();
+                  error = pos.urbino_verify();
+                  ++nodes;
+              }
+
+              if (!error.empty())
+              {
+                  std::stringstream ss;
+                  ss << "info string fuzz: " << error << " (seed " << seed << ")"
+                     << "\ninfo string position fen " << fen << " moves";
+                  for (size_t i = 0; i < moves.size(); ++i)
+                      ss << " " << game[i];
+                  if (moves.size() < game.size())
+                  {
+                      ss << "\ninfo string reached by undoing";
+                      for (size_t i = game.size(); i-- > moves.size(); )
+                          ss << " " << game[i];
+                  }
+
+                  std::lock_guard<std::mutex> lock(mutex);
+                  if (!failed)
+                      failure = ss.str();
+                  failed = true;
+              }
+
+              ++played;
+          }
+      });
+
+  // Report the progress while the workers run
+  for (TimePoint last = now(); played < games && !failed; )
+  {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      if (now() - last >= 10000)
+      {
+          last = now();
+          sync_cout << "info string fuzz: " << played << " games, " << nodes << " positions, "
+                    << nodes * 1000 / (now() - elapsed + 1) << " positions/s" << sync_endl;
+      }
+  }
+
+  for (std::thread& w : workers)
+      w.join();
+
+  elapsed = now() - elapsed + 1;
+
+  if (failed)
+      sync_cout << failure << sync_endl;
+  else
+      sync_cout << "info string fuzz: " << played << " games, " << nodes << " positions, "
+                << nodes * 1000 / elapsed << " positions/s, no differences (seed " << seed << ")" << sync_endl;
+}
+
+} // namespace Stockfish
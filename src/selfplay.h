@@ -0,0 +1,46 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2022 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SELFPLAY_H_INCLUDED
+#define SELFPLAY_H_INCLUDED
+
+#include <iosfwd>
+
+namespace Stockfish {
+
+class Position;
+
+/// SelfPlay namespace implements in-process games of the engine against
+/// itself, to generate training data, to play matches and to tune
+/// parameters. The games are played side by side, one on each thread of the
+/// pool, and each player has a private search instance of one thread. Only
+/// the tuning games of parameters that are not TUNABLE are played one after
+/// the other. The fuzz test plays random games on all threads at once.
+
+namespace SelfPlay {
+
+void generate_training_data(const Position& pos, std::istream& is);
+void match(const Position& pos, std::istream& is);
+void spsa(const Position& pos, std::istream& is);
+void fuzz(const Position& pos, std::istream& is);
+
+} // namespace SelfPlay
+
+} // namespace Stockfish
+
+#endif // #ifndef SELFPLAY_H_INCLUDED
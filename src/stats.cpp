@@ -0,0 +1,126 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2022 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <iomanip>
+#include <sstream>
+
+#include "movepick.h"
+#include "stats.h"
+#include "thread.h"
+
+namespace Stockfish {
+
+#ifdef USE_STATS
+
+namespace {
+
+  double ratio(uint64_t a, uint64_t b) { return b ? double(a) / b : 0.0; }
+
+} // namespace
+
+
+/// SearchStats::json() sums the counters of all threads for the "stats" command.
+/// They cover the last search started by the thread pool, plus any searches
+/// that borrowed the pool threads since then (selfplay, spsa).
+
+std::string SearchStats::json() {
+
+  SearchStats s;
+  uint64_t nodes = 0;
+
+  for (Thread* th : Threads)
+  {
+      const SearchStats& t = th->stats;
+      nodes += th->nodes;
+      for (int d = 0; d < SearchStats::DEPTH_NB; ++d)
+          s.ttProbes[d] += t.ttProbes[d], s.ttHits[d] += t.ttHits[d];
+      for (int i = 0; i < SearchStats::STAGE_NB; ++i)
+          s.cutoffs[i] += t.cutoffs[i];
+      for (int i = 0; i < SearchStats::MERGE_NB; ++i)
+          s.merges[i] += t.merges[i];
+      s.legalBuilds += t.legalBuilds;
+      s.legalBuildHits += t.legalBuildHits;
+      s.moveNodes += t.moveNodes;
+      s.movesGenerated += t.movesGenerated;
+      s.movesSearched += t.movesSearched;
+      s.mergedSquares += t.mergedSquares;
+  }
+
+  uint64_t probes = 0, hits = 0, cutoffs = 0, merges = 0;
+  for (int d = 0; d < SearchStats::DEPTH_NB; ++d)
+      probes += s.ttProbes[d], hits += s.ttHits[d];
+  for (int i = 0; i < SearchStats::STAGE_NB; ++i)
+      cutoffs += s.cutoffs[i];
+  for (int i = 0; i < SearchStats::MERGE_NB; ++i)
+      merges += s.merges[i];
+
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(4)
+     << "{\n  \"threads\": " << Threads.size()
+     << ",\n  \"nodes\": " << nodes
+     << ",\n  \"tt\": {\n    \"probes\": " << probes
+     << ",\n    \"hits\": " << hits
+     << ",\n    \"hit_rate\": " << ratio(hits, probes)
+     << ",\n    \"by_depth\": [";
+
+  const char* sep = "";
+  for (int d = 0; d < SearchStats::DEPTH_NB; ++d)
+      if (s.ttProbes[d])
+      {
+          ss << sep << "\n      { \"depth\": " << d
+             << ", \"probes\": " << s.ttProbes[d]
+             << ", \"hits\": " << s.ttHits[d]
+             << ", \"hit_rate\": " << ratio(s.ttHits[d], s.ttProbes[d]) << " }";
+          sep = ",";
+      }
+
+  ss << "\n    ]\n  },\n  \"legal_build\": {\n    \"calls\": " << s.legalBuilds
+     << ",\n    \"cache_hits\": " << s.legalBuildHits
+     << ",\n    \"hit_rate\": " << ratio(s.legalBuildHits, s.legalBuilds)
+     << "\n  },\n  \"cutoffs\": {\n    \"total\": " << cutoffs;
+
+  for (int i = 0; i < SearchStats::STAGE_NB; ++i)
+      if (s.cutoffs[i])
+          ss << ",\n    \"" << MovePicker::stage_name(i) << "\": " << s.cutoffs[i];
+
+  ss << "\n  },\n  \"moves\": {\n    \"nodes\": " << s.moveNodes
+     << ",\n    \"generated\": " << s.movesGenerated
+     << ",\n    \"searched\": " << s.movesSearched
+     << ",\n    \"generated_per_node\": " << ratio(s.movesGenerated, s.moveNodes)
+     << ",\n    \"searched_per_node\": " << ratio(s.movesSearched, s.moveNodes)
+     << "\n  },\n  \"district_merges\": {\n    \"builds\": " << merges
+     << ",\n    \"by_adjacent_districts\": [";
+
+  for (int i = 0; i < SearchStats::MERGE_NB; ++i)
+      ss << (i ? ", " : "") << s.merges[i];
+
+  ss << "],\n    \"mean_district_size\": " << ratio(s.mergedSquares, merges)
+     << "\n  }\n}";
+
+  return ss.str();
+}
+
+#else
+
+std::string SearchStats::json() {
+  return "info string Search statistics need a build with stats=yes";
+}
+
+#endif
+
+} // namespace Stockfish
@@ -0,0 +1,83 @@
+/*
+  Stockfish, a UCI chess playing engine derived from Glaurung 2.1
+  Copyright (C) 2004-2022 The Stockfish developers (see AUTHORS file)
+
+  Stockfish is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Stockfish is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef STATS_H_INCLUDED
+#define STATS_H_INCLUDED
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include "types.h"
+
+/// STATS() compiles its argument only in builds with stats=yes, so that the
+/// counters cost nothing in normal builds.
+
+#ifdef USE_STATS
+#define STATS(...) __VA_ARGS__
+#else
+#define STATS(...)
+#endif
+
+namespace Stockfish {
+
+/// SearchStats holds the hot-path counters of one thread. They are cleared
+/// at the start of each search and are not shared, so no atomics are needed.
+
+struct SearchStats {
+
+  static constexpr int DEPTH_NB = 32; // Last bucket also counts deeper probes
+  static constexpr int STAGE_NB = 32;
+  static constexpr int MERGE_NB = 5;  // A build touches at most 4 districts
+
+  static std::string json();
+
+  void clear() { *this = SearchStats(); }
+
+  void tt_probe(Depth d, bool hit) {
+    int b = std::clamp(int(d), 0, DEPTH_NB - 1); // Quiescence search in bucket 0
+    ++ttProbes[b];
+    ttHits[b] += hit;
+  }
+
+  void legal_build(bool cached) {
+    ++legalBuilds;
+    legalBuildHits += cached;
+  }
+
+  void node(int generated, int searched) {
+    ++moveNodes;
+    movesGenerated += generated;
+    movesSearched += searched;
+  }
+
+  void merge(int districts, int squares) {
+    ++merges[districts];
+    mergedSquares += squares;
+  }
+
+  uint64_t ttProbes[DEPTH_NB] = {}, ttHits[DEPTH_NB] = {};
+  uint64_t legalBuilds = 0, legalBuildHits = 0;
+  uint64_t cutoffs[STAGE_NB] = {};
+  uint64_t moveNodes = 0, movesGenerated = 0, movesSearched = 0;
+  uint64_t merges[MERGE_NB] = {}, mergedSquares = 0;
+};
+
+} // namespace Stockfish
+
+#endif // #ifndef STATS_H_INCLUDED
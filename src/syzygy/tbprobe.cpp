@@ -1536,7 +1536,7 @@ bool Tablebases::root_probe(Position& pos, Search::RootMoves& rootMoves) {
     // Probe and rank each move
     for (auto& m : rootMoves)
     {
-        pos.do_move(m.pv[0], st);
+        pos.do_move(m.move, st);
 
         // Calculate dtz for the current move counting from the root position
         if (pos.rule50_count() == 0)
@@ -1567,7 +1567,7 @@ bool Tablebases::root_probe(Position& pos, Search::RootMoves& rootMoves) {
             && MoveList<LEGAL>(pos).size() == 0)
             dtz = 1;
 
-        pos.undo_move(m.pv[0]);
+        pos.undo_move(m.move);
 
         if (result == FAIL)
             return false;
@@ -1610,14 +1610,14 @@ bool Tablebases::root_probe_wdl(Position& pos, Search::RootMoves& rootMoves) {
     // Probe and rank each move
     for (auto& m : rootMoves)
     {
-        pos.do_move(m.pv[0], st);
+        pos.do_move(m.move, st);
 
         if (pos.is_draw(1))
             wdl = WDLDraw;
         else
             wdl = -probe_wdl(pos, &result);
 
-        pos.undo_move(m.pv[0]);
+        pos.undo_move(m.move);
 
         if (result == FAIL)
             return false;
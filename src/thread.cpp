@@ -25,18 +25,18 @@
 #include "thread.h"
 #include "uci.h"
 #include "syzygy/tbprobe.h"
+#include "timeman.h"
 #include "tt.h"
 #include "xboard.h"
 
 namespace Stockfish {
 
-ThreadPool Threads; // Global object
-
+ThreadPool Threads(TT, Time, Search::Limits, Options); // Global object
 
 /// Thread constructor launches the thread and waits until it goes to sleep
 /// in idle_loop(). Note that 'searching' and 'exit' should be already set.
 
-Thread::Thread(size_t n) : idx(n), stdThread(&Thread::idle_loop, this) {
+Thread::Thread(size_t n, ThreadPool& p) : pool(p), idx(n), stdThread(&Thread::idle_loop, this) {
 
   wait_for_search_finished();
 }
@@ -73,6 +73,13 @@ void Thread::clear() {
                       h->fill(0);
           continuationHistory[inCheck][c][NO_PIECE][0]->fill(Search::CounterMovePruneThreshold - 1);
       }
+
+  evalCache = Eval::Cache();
+
+  ttCache.resize(pool.tt, size_t(Options["TT Cache Size"]),
+                   Options["TT Cache"] == "write-through" ? TTCache::WRITE_THROUGH
+                 : Options["TT Cache"] == "write-back"    ? TTCache::WRITE_BACK
+                                                          : TTCache::OFF);
 }
 
 
@@ -105,10 +112,17 @@ void Thread::idle_loop() {
   // the choice, eventually we are one of many one-threaded processes running on
   // some Windows NUMA hardware, for instance in fishtest. To make it simple,
   // just check if running threads are below a threshold, in this case all this
-  // NUMA machinery is not needed.
-  if (Options["Threads"] > 8)
+  // NUMA machinery is not needed. The private pools are left to the OS.
+  if (&pool == &Threads && Options["Threads"] > 8)
       WinProcGroup::bindThisThread(idx);
 
+  // Optionally pin the search threads round-robin to the NUMA nodes
+  if (&pool == &Threads && Options["Bind Threads"])
+      Numa::bind_this_thread(idx);
+
+  TTCache::local = &ttCache;
+  Tune::local = pool.tunables;
+
   while (true)
   {
       std::unique_lock<std::mutex> lk(mutex);
@@ -131,6 +145,9 @@ void Thread::idle_loop() {
     //       sync_cout << "DEBUG: idle_loop about to call search(), stop=" << Threads.stop << sync_endl;
     //   }
       search();
+
+      // Write back what is left in the TT cache
+      ttCache.flush();
   }
 }
 
@@ -150,14 +167,20 @@ void ThreadPool::set(size_t requested) {
 
   if (requested > 0)   // create new thread(s)
   {
-      push_back(new MainThread(0));
+      push_back(new MainThread(0, *this));
 
       while (size() < requested)
-          push_back(new Thread(size()));
+          push_back(new Thread(size(), *this));
       clear();
 
-      // Reallocate the hash with the new threadpool size
-      TT.resize(size_t(Options["Hash"]));
+      // The private pools size their own table
+      if (this != &Threads)
+          return;
+
+      // Reallocate the hash with the new threadpool size, or read again the
+      // file it was loaded from
+      if (!TT.reload())
+          TT.resize(size_t(Options["Hash"]));
 
       // Init thread number dependent search params.
       Search::init();
@@ -182,7 +205,7 @@ void ThreadPool::clear() {
 /// returns immediately. Main thread will wake up other threads and start the search.
 
 void ThreadPool::start_thinking(Position& pos, StateListPtr& states,
-                                const Search::LimitsType& limits, bool ponderMode) {
+                                const Search::LimitsType& searchLimits, bool ponderMode) {
 
   main()->wait_for_search_finished();
 
@@ -192,13 +215,14 @@ void ThreadPool::start_thinking(Position& pos, StateListPtr& states,
 //   }
   increaseDepth = true;
   main()->ponder = ponderMode;
-  Search::Limits = limits;
-  Search::RootMoves rootMoves;
+  limits = searchLimits;
+
+  Search::RootMoves moves;
 
   for (const auto& m : MoveList<LEGAL>(pos))
       if (   (limits.searchmoves.empty() || std::count(limits.searchmoves.begin(), limits.searchmoves.end(), m))
           && (limits.banmoves.empty() || !std::count(limits.banmoves.begin(), limits.banmoves.end(), m)))
-          rootMoves.emplace_back(m);
+          moves.emplace_back(m);
 
   // Add virtual drops
   if (pos.two_boards() && Partner.opptime && limits.time[pos.side_to_move()] > Partner.opptime + 1000)
@@ -207,18 +231,25 @@ void ThreadPool::start_thinking(Position& pos, StateListPtr& states,
       {
           for (const auto& m : MoveList<EVASIONS>(pos))
               if (pos.virtual_drop(m) && pos.legal(m))
-                  rootMoves.emplace_back(m);
+                  moves.emplace_back(m);
       }
       else
       {
           for (const auto& m : MoveList<QUIETS>(pos))
               if (pos.virtual_drop(m) && pos.legal(m))
-                  rootMoves.emplace_back(m);
+                  moves.emplace_back(m);
       }
   }
 
-  if (!rootMoves.empty())
-      Tablebases::rank_root_moves(pos, rootMoves);
+  if (!moves.empty())
+      Tablebases::rank_root_moves(pos, moves);
+
+  // The lines of the previous search still point into the old list, so it is
+  // replaced only once they have been read
+  if (options["Keep Search State"] && !moves.empty())
+      Search::seed_root_moves(pos, moves, main()->rootLines, lastRootKey, tt);
+
+  lastRootKey = pos.key();
 
   // After ownership transfer 'states' becomes empty, so if we stop the search
   // and call 'go' again without setting a new position states.get() == NULL.
@@ -227,18 +258,19 @@ void ThreadPool::start_thinking(Position& pos, StateListPtr& states,
   if (states.get())
       setupStates = std::move(states); // Ownership transfer, states is now empty
 
-  // We use Position::set() to set root position across threads. But there are
-  // some StateInfo fields (previous, pliesFromNull, capturedPiece) that cannot
-  // be deduced from a fen string, so set() clears them and they are set from
-  // setupStates->back() later. The rootState is per thread, earlier states are shared
-  // since they are read-only.
+  // The root position is copied into every thread. The rootState is per
+  // thread, earlier states are shared since they are read-only. The root
+  // moves are shared read-only too, each thread sets up its own lines over
+  // them when it starts searching (see Thread::search()).
+  rootMoves = std::move(moves);
+
   for (Thread* th : *this)
   {
       th->nodes = th->tbHits = th->nmpMinPly = th->bestMoveChanges = 0;
       th->rootDepth = th->completedDepth = 0;
-      th->rootMoves = rootMoves;
-      th->rootPos.set(pos.variant(), pos.fen(), pos.is_chess960(), &th->rootState, th);
-      th->rootState = setupStates->back();
+      th->rootLines.clear();
+      STATS(th->stats.clear());
+      th->rootPos.set(pos, &th->rootState, th);
   }
 
 //   if (pos.urbino_gating()) {
@@ -258,23 +290,23 @@ Thread* ThreadPool::get_best_thread() const {
 
     // Find minimum score of all threads
     for (Thread* th: *this)
-        minScore = std::min(minScore, th->rootMoves[0].score);
+        minScore = std::min(minScore, th->rootLines[0].score);
 
     // Vote according to score and depth, and select the best thread
     for (Thread* th : *this)
     {
-        votes[th->rootMoves[0].pv[0]] +=
-            (th->rootMoves[0].score - minScore + 14) * int(th->completedDepth);
+        votes[th->rootLines[0].move()] +=
+            (th->rootLines[0].score - minScore + 14) * int(th->completedDepth);
 
-        if (abs(bestThread->rootMoves[0].score) >= VALUE_TB_WIN_IN_MAX_PLY)
+        if (abs(bestThread->rootLines[0].score) >= VALUE_TB_WIN_IN_MAX_PLY)
         {
             // Make sure we pick the shortest mate / TB conversion or stave off mate the longest
-            if (th->rootMoves[0].score > bestThread->rootMoves[0].score)
+            if (th->rootLines[0].score > bestThread->rootLines[0].score)
                 bestThread = th;
         }
-        else if (   th->rootMoves[0].score >= VALUE_TB_WIN_IN_MAX_PLY
-                 || (   th->rootMoves[0].score > VALUE_TB_LOSS_IN_MAX_PLY
-                     && votes[th->rootMoves[0].pv[0]] > votes[bestThread->rootMoves[0].pv[0]]))
+        else if (   th->rootLines[0].score >= VALUE_TB_WIN_IN_MAX_PLY
+                 || (   th->rootLines[0].score > VALUE_TB_LOSS_IN_MAX_PLY
+                     && votes[th->rootLines[0].move()] > votes[bestThread->rootLines[0].move()]))
             bestThread = th;
     }
 
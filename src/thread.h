@@ -25,15 +25,22 @@
 #include <thread>
 #include <vector>
 
+#include "evaluate.h"
 #include "material.h"
 #include "movepick.h"
 #include "pawns.h"
 #include "position.h"
 #include "search.h"
+#include "stats.h"
 #include "thread_win32_osx.h"
+#include "tt.h"
+#include "uci.h"
 
 namespace Stockfish {
 
+class TimeManagement;
+struct ThreadPool;
+
 /// Thread class keeps together all the thread-related stuff. We use
 /// per-thread pawn and material hash tables so that once we get a
 /// pointer to an entry its life time is unlimited and we don't have
@@ -41,6 +48,10 @@ namespace Stockfish {
 
 class Thread {
 
+public:
+  ThreadPool& pool; // Set before starting std::thread
+
+private:
   std::mutex mutex;
   std::condition_variable cv;
   size_t idx;
@@ -48,7 +59,7 @@ class Thread {
   NativeThread stdThread;
 
 public:
-  explicit Thread(size_t);
+  Thread(size_t, ThreadPool&);
   virtual ~Thread();
   virtual void search();
   void clear();
@@ -59,6 +70,7 @@ public:
 
   Pawns::Table pawnsTable;
   Material::Table materialTable;
+  Eval::Cache evalCache;
   size_t pvIdx, pvLast;
   uint64_t ttHitAverage;
   int selDepth, nmpMinPly;
@@ -67,7 +79,7 @@ public:
 
   Position rootPos;
   StateInfo rootState;
-  Search::RootMoves rootMoves;
+  Search::RootLines rootLines;
   Depth rootDepth, completedDepth;
   CounterMoveHistory counterMoves;
   ButterflyHistory mainHistory;
@@ -75,7 +87,11 @@ public:
   LowPlyHistory lowPlyHistory;
   CapturePieceToHistory captureHistory;
   ContinuationHistory continuationHistory[2][2];
+  TTCache ttCache;
   Score trend;
+#ifdef USE_STATS
+  SearchStats stats;
+#endif
 };
 
 
@@ -100,10 +116,15 @@ struct MainThread : public Thread {
 
 /// ThreadPool struct handles all the threads-related stuff like init, starting,
 /// parking and, most importantly, launching a thread. All the access to threads
-/// is done through this class.
+/// is done through this class. A pool searches with its own transposition
+/// table, time manager, limits and options. Threads is the pool of the UCI
+/// commands, the selfplay commands make private ones that search silently.
 
 struct ThreadPool : public std::vector<Thread*> {
 
+  ThreadPool(TranspositionTable& t, TimeManagement& tm, Search::LimitsType& l, UCI::OptionsMap& o)
+    : tt(t), time(tm), limits(l), options(o) {}
+
   void start_thinking(Position&, StateListPtr&, const Search::LimitsType&, bool = false);
   void clear();
   void set(size_t);
@@ -115,10 +136,19 @@ struct ThreadPool : public std::vector<Thread*> {
   void start_searching();
   void wait_for_search_finished() const;
 
+  TranspositionTable& tt;
+  TimeManagement& time;
+  Search::LimitsType& limits;
+  UCI::OptionsMap& options; // Read for Skill Level, UCI_Elo, UCI_LimitStrength, MultiPV,
+                            // Keep Search State, Move Overhead, Slow Mover and nodestime
+  const int* tunables = nullptr; // Values of the TUNABLE parameters, see Tune::local
+
   std::atomic_bool stop, increaseDepth;
   std::atomic_bool abort, sit;
 
   StateListPtr setupStates;
+  Search::RootMoves rootMoves;
+  Key lastRootKey;
 
 private:
   uint64_t accumulate(std::atomic<uint64_t> Thread::* member) const {
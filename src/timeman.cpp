@@ -29,6 +29,54 @@ namespace Stockfish {
 
 TimeManagement Time; // Our global time management object
 
+namespace {
+
+  // Never plan for fewer moves than this while buildings are left in hand, as
+  // the estimate from the free squares can be far too low in the midgame.
+  constexpr int UrbinoMinMovesToGo = 5;
+
+  // urbino_moves_to_go() estimates how many moves we have left in an Urbino
+  // game. Every move places one of our buildings, so the buildings in hand
+  // are an upper bound. Once the board fills up the game ends earlier: the
+  // squares where both sides can build are shared with the opponent, those
+  // only we can use are ours. It also returns how far into the game we are,
+  // as a fraction of our own moves.
+
+  int urbino_moves_to_go(const Position& pos, Color us, double& progress) {
+
+    int inHand = 0, placed = 0;
+    for (PieceType pt : { CUSTOM_PIECE_2, CUSTOM_PIECE_3, CUSTOM_PIECE_4 })
+    {
+        inHand += pos.count_in_hand(us, pt);
+        placed += pos.count(us, pt);
+    }
+
+    int ours = 0, shared = 0;
+    Bitboard empty = pos.board_bb() & ~pos.pieces();
+    while (empty)
+    {
+        Square s = pop_lsb(empty);
+        if (pos.urbino_legal_build(us, s))
+            ++(pos.urbino_legal_build(~us, s) ? shared : ours);
+    }
+
+    int movesLeft = std::min(inHand, std::max(ours + (shared + 1) / 2, UrbinoMinMovesToGo));
+    movesLeft = std::max(movesLeft, 1);
+    progress = double(placed) / (placed + movesLeft);
+
+    return movesLeft;
+  }
+
+  // Relative weight of a move at a given game progress. The branching factor
+  // peaks in the midgame, while the first moves and the last, nearly forced,
+  // ones need less time.
+
+  double urbino_move_weight(double progress) {
+    return 0.5 + 4.0 * progress * (1.0 - progress);
+  }
+
+} // namespace
+
 
 /// TimeManagement::init() is called at the beginning of the search and calculates
 /// the bounds of time allowed for the current game ply. We currently support:
@@ -37,9 +85,11 @@ TimeManagement Time; // Our global time management object
 
 void TimeManagement::init(const Position& pos, Search::LimitsType& limits, Color us, int ply) {
 
-  TimePoint moveOverhead    = TimePoint(Options["Move Overhead"]);
-  TimePoint slowMover       = TimePoint(Options["Slow Mover"]);
-  TimePoint npmsec          = TimePoint(Options["nodestime"]);
+  pool = &pos.this_thread()->pool;
+
+  TimePoint moveOverhead    = TimePoint(pool->options["Move Overhead"]);
+  TimePoint slowMover       = TimePoint(pool->options["Slow Mover"]);
+  TimePoint npmsec          = TimePoint(pool->options["nodestime"]);
 
   // optScale is a percentage of available time to use for the current move.
   // maxScale is a multiplier applied to optimumTime.
@@ -65,6 +115,11 @@ void TimeManagement::init(const Position& pos, Search::LimitsType& limits, Color
   // Maximum move horizon of 50 moves
   int mtg = limits.movestogo ? std::min(limits.movestogo, 50) : 50;
 
+  // In Urbino the horizon is given by the buildings left to place
+  double progress = 0.0;
+  if (pos.urbino_gating())
+      mtg = std::min(mtg, urbino_moves_to_go(pos, us, progress));
+
   // Make sure timeLeft is > 0 since we may use it as a divisor
   TimePoint timeLeft =  std::max(TimePoint(1),
       limits.time[us] + limits.inc[us] * (mtg - 1) - moveOverhead * (2 + mtg));
@@ -86,10 +141,25 @@ void TimeManagement::init(const Position& pos, Search::LimitsType& limits, Color
   // Default is 100 and changing this value will probably lose elo.
   timeLeft = slowMover * timeLeft / 100;
 
+  // Urbino: share the remaining time over the known number of moves left,
+  // weighting each one by urbino_move_weight(), but never more than 20% of
+  // the clock on one move in case the estimate is too low. Near the end there
+  // is little room left to exceed the optimum time.
+  if (pos.urbino_gating())
+  {
+      double weights = 0.0;
+      for (int i = 0; i < mtg; ++i)
+          weights += urbino_move_weight(progress + i * (1.0 - progress) / mtg);
+
+      optScale = std::min(urbino_move_weight(progress) / weights,
+                          0.2 * limits.time[us] / double(timeLeft));
+      maxScale = std::min(4.0, 1.0 + 0.25 * mtg);
+  }
+
   // x basetime (+ z increment)
   // If there is a healthy increment, timeLeft can exceed actual available
   // game time for the current move, so also cap to 20% of available game time.
-  if (limits.movestogo == 0)
+  else if (limits.movestogo == 0)
   {
       optScale = std::min(0.0084 + std::pow(ply + 3.0, 0.5) * 0.0042,
                            0.2 * limits.time[us] / double(timeLeft));
@@ -33,12 +33,13 @@ public:
   void init(const Position& pos, Search::LimitsType& limits, Color us, int ply);
   TimePoint optimum() const { return optimumTime; }
   TimePoint maximum() const { return maximumTime; }
-  TimePoint elapsed() const { return Search::Limits.npmsec ?
-                                     TimePoint(Threads.nodes_searched()) : now() - startTime; }
+  TimePoint elapsed() const { return pool->limits.npmsec ?
+                                     TimePoint(pool->nodes_searched()) : now() - startTime; }
 
-  int64_t availableNodes; // When in 'nodes as time' mode
+  int64_t availableNodes = 0; // When in 'nodes as time' mode
 
 private:
+  const ThreadPool* pool = &Threads; // The pool of the search, set by init()
   TimePoint startTime;
   TimePoint optimumTime;
   TimePoint maximumTime;
@@ -17,11 +17,22 @@
 */
 
 #include <cstring>   // For std::memset
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <thread>
 
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#define USE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "bitboard.h"
 #include "misc.h"
+#include "position.h"
 #include "thread.h"
 #include "tt.h"
 #include "uci.h"
@@ -30,18 +41,151 @@ namespace Stockfish {
 
 TranspositionTable TT; // Our global transposition table
 
+thread_local TTCache* TTCache::local = nullptr;
+std::atomic<int> TTCache::enabledCount;
+
+namespace {
+
+  // Header of a TT file as written by "tt save". It is followed by the raw
+  // clusters, so that the table can be mapped straight from the file. The
+  // header is one cache line long to keep the mapped clusters aligned.
+  struct TTFileHeader {
+    char magic[8];
+    uint64_t clusterSize;
+    uint64_t clusterCount;
+    uint8_t generation8;
+    uint8_t entrySize;
+    char padding[38];
+  };
+
+  static_assert(sizeof(TTFileHeader) == 64, "Unexpected TTFileHeader size");
+
+  constexpr char TTFileMagic[8] = { 'F', 'S', 'T', 'T', '0', '0', '0', '1' };
+
+  bool valid_header(const TTFileHeader& h, size_t clusterSize) {
+    return   !std::memcmp(h.magic, TTFileMagic, sizeof(TTFileMagic))
+          && h.clusterSize == clusterSize
+          && h.entrySize == sizeof(TTEntry)
+          && h.clusterCount > 0;
+  }
+
+#ifdef URBINO_TT
+  // Urbino moves are packed into 16 bits. Squares are numbered 0-80 on the
+  // 9x9 board and building types 0-2. An architect move only records whether
+  // the architect on the lower or on the higher square moved. Code 0 means
+  // no move, which is also used for moves that cannot be packed.
+  constexpr int BoardSize   = 9;
+  constexpr int SquareCount = BoardSize * BoardSize;
+  constexpr int NormalBase  = 1;
+  constexpr int BuildBase   = NormalBase + SquareCount * SquareCount * 3 * 2;
+  constexpr int PassBase    = BuildBase + SquareCount * 3;
+  constexpr int DropBase    = PassBase + SquareCount;
+  constexpr int CodeEnd     = DropBase + SquareCount;
+
+  static_assert(CodeEnd <= 1 << 16, "Urbino moves do not fit into 16 bits");
+
+  int square_index(Square s) {
+    return file_of(s) < BoardSize && rank_of(s) < BoardSize ? file_of(s) + BoardSize * rank_of(s) : -1;
+  }
+
+  Square index_square(int idx) {
+    return make_square(File(idx % BoardSize), Rank(idx / BoardSize));
+  }
+
+  int building_index(PieceType pt) {
+    return pt >= CUSTOM_PIECE_2 && pt <= CUSTOM_PIECE_4 ? pt - CUSTOM_PIECE_2 : -1;
+  }
+
+  uint16_t pack_move(const Position& pos, Move m) {
+
+    Square from = from_sq(m), to = to_sq(m);
+    int t = square_index(to);
+    int g = square_index(gating_square(m)), b = building_index(gating_type(m));
+
+    if (m == MOVE_NONE || t < 0)
+        return 0;
+
+    if (type_of(m) == NORMAL && g >= 0 && b >= 0 && (pos.pieces(CUSTOM_PIECE_1) & from))
+        return uint16_t(NormalBase + ((t * SquareCount + g) * 3 + b) * 2 + (from == msb(pos.pieces(CUSTOM_PIECE_1))));
+
+    if (type_of(m) == SPECIAL && from == to)
+        return  gating_type(m) == NO_PIECE_TYPE ? uint16_t(PassBase + t)
+              : to == SQ_A1 && g >= 0 && b >= 0 ? uint16_t(BuildBase + g * 3 + b) : 0;
+
+    if (   type_of(m) == DROP
+        && in_hand_piece_type(m) == CUSTOM_PIECE_1
+        && dropped_piece_type(m) == CUSTOM_PIECE_1)
+        return uint16_t(DropBase + t);
+
+    return 0;
+  }
+
+  Move unpack_move(const Position& pos, int code) {
+
+    if (code < NormalBase || code >= CodeEnd)
+        return MOVE_NONE;
+
+    if (code < BuildBase)
+    {
+        Bitboard architects = pos.pieces(CUSTOM_PIECE_1);
+        if (!architects)
+            return MOVE_NONE;
+
+        code -= NormalBase;
+        Square from = code & 1 ? msb(architects) : lsb(architects);
+        code >>= 1;
+        return make_gating<NORMAL>(from, index_square(code / 3 / SquareCount),
+                                   PieceType(CUSTOM_PIECE_2 + code % 3),
+                                   index_square(code / 3 % SquareCount));
+    }
+
+    if (code < PassBase)
+        return make_gating<SPECIAL>(SQ_A1, SQ_A1, PieceType(CUSTOM_PIECE_2 + (code - BuildBase) % 3),
+                                    index_square((code - BuildBase) / 3));
+
+    if (code < DropBase)
+        return make<SPECIAL>(index_square(code - PassBase), index_square(code - PassBase));
+
+    return make_drop(index_square(code - DropBase), CUSTOM_PIECE_1, CUSTOM_PIECE_1);
+  }
+#endif
+
+} // namespace
+
 /// TTEntry::save() populates the TTEntry with a new node's data, possibly
 /// overwriting an old position. Update is not atomic and can be racy.
 
-void TTEntry::save(Key k, Value v, bool pv, Bound b, Depth d, Move m, Value ev) {
+void TTEntry::save(Key k, Value v, bool pv, Bound b, Depth d, Move m, Value ev, const Position& pos) {
+
+  // Entries of the calling thread's cache are passed on to the TT. The thread
+  // local pointer is only looked up while some thread has a cache. An entry
+  // of the cache that was given to another position since it was probed is
+  // overwritten like one of another key.
+  TTCache* cache = TTCache::enabledCount.load(std::memory_order_relaxed) ? TTCache::local : nullptr;
+  const bool stale = cache && cache->stale(this, k);
+
+#ifdef URBINO_TT
+  int shift;
+  std::atomic<uint32_t>& keyExt = TranspositionTable::key_ext(this, shift);
+  const uint32_t mask = (1 << TranspositionTable::KeyExtBits) - 1;
+  const uint32_t ext = uint32_t(k >> 16) & mask;
+  const bool otherKey = stale || (uint16_t)k != key16 || ((keyExt.load(std::memory_order_relaxed) >> shift) & mask) != ext;
 
   // Preserve any existing move for the same position
-  if (m || (uint16_t)k != key16)
+  if (m || otherKey)
+      move16 = pack_move(pos, m);
+#else
+  const bool otherKey = stale || (uint16_t)k != key16;
+
+  // Preserve any existing move for the same position
+  if (m || otherKey)
       move32 = (uint32_t)m;
+  (void)pos;
+#endif
 
   // Overwrite less valuable entries (cheapest checks first)
   if (b == BOUND_EXACT
-      || (uint16_t)k != key16
+      || otherKey
       || d - DEPTH_OFFSET > depth8 - 4)
   {
       assert(d > DEPTH_OFFSET);
@@ -49,13 +193,82 @@ void TTEntry::save(Key k, Value v, bool pv, Bound b, Depth d, Move m, Value ev)
 
       key16     = (uint16_t)k;
       depth8    = (uint8_t)(d - DEPTH_OFFSET);
-      genBound8 = (uint8_t)(TT.generation8 | uint8_t(pv) << 2 | b);
+      genBound8 = (uint8_t)(pos.this_thread()->pool.tt.generation8 | uint8_t(pv) << 2 | b);
       value16   = (int16_t)v;
       eval16    = (int16_t)ev;
+#ifdef URBINO_TT
+      TranspositionTable::set_key_ext(keyExt, shift, ext);
+#endif
+  }
+
+  if (cache)
+      cache->saved(this, k, v, pv, b, d, m, ev, pos);
+}
+
+#ifdef URBINO_TT
+Move TTEntry::move(const Position& pos) const { return unpack_move(pos, move16); }
+#endif
+
+
+/// TTEntry::save() is an overload that copies the data of another entry, as
+/// stored, with the same replacement rule. It writes the entries of the
+/// per-thread caches back to the TT.
+
+void TTEntry::save(Key k, const TTEntry& e) {
+
+#ifdef URBINO_TT
+  int shift;
+  std::atomic<uint32_t>& keyExt = TranspositionTable::key_ext(this, shift);
+  const uint32_t mask = (1 << TranspositionTable::KeyExtBits) - 1;
+  const uint32_t ext = uint32_t(k >> 16) & mask;
+  const bool otherKey = (uint16_t)k != key16 || ((keyExt.load(std::memory_order_relaxed) >> shift) & mask) != ext;
+
+  if (e.move16 || otherKey)
+      move16 = e.move16;
+#else
+  const bool otherKey = (uint16_t)k != key16;
+
+  if (e.move32 || otherKey)
+      move32 = e.move32;
+#endif
+
+  if ((e.genBound8 & 0x3) == BOUND_EXACT
+      || otherKey
+      || e.depth8 > depth8 - 4)
+  {
+      key16     = (uint16_t)k;
+      depth8    = e.depth8;
+      genBound8 = e.genBound8;
+      value16   = e.value16;
+      eval16    = e.eval16;
+#ifdef URBINO_TT
+      TranspositionTable::set_key_ext(keyExt, shift, ext);
+#endif
   }
 }
 
 
+/// TTEntry::copy() overwrites the entry with another one, whatever it holds.
+/// It fills the per-thread caches from the TT.
+
+void TTEntry::copy(Key k, const TTEntry& e) {
+
+  key16     = (uint16_t)k;
+  depth8    = e.depth8;
+  genBound8 = e.genBound8;
+  value16   = e.value16;
+  eval16    = e.eval16;
+#ifdef URBINO_TT
+  move16    = e.move16;
+  int shift;
+  TranspositionTable::set_key_ext(TranspositionTable::key_ext(this, shift), shift,
+                                  uint32_t(k >> 16) & ((1 << TranspositionTable::KeyExtBits) - 1));
+#else
+  move32    = e.move32;
+#endif
+}
+
+
 /// TranspositionTable::resize() sets the size of the transposition table,
 /// measured in megabytes. Transposition table consists of a power of 2 number
 /// of clusters and each cluster consists of ClusterSize number of TTEntry.
@@ -64,7 +277,7 @@ void TranspositionTable::resize(size_t mbSize) {
 
   Threads.main()->wait_for_search_finished();
 
-  aligned_large_pages_free(table);
+  free();
 
   clusterCount = mbSize * 1024 * 1024 / sizeof(Cluster);
 
@@ -76,37 +289,196 @@ void TranspositionTable::resize(size_t mbSize) {
       exit(EXIT_FAILURE);
   }
 
+  // Spread the table over the NUMA nodes before it is first touched
+  if (Options["NUMA Policy"] == "interleave")
+      Numa::interleave(table, clusterCount * sizeof(Cluster));
+
   clear();
 }
 
 
+/// TranspositionTable::free() releases the table, whether it was allocated or
+/// mapped from a file.
+
+void TranspositionTable::free() {
+
+  sourceFile.clear();
+
+#ifdef USE_MMAP
+  if (mappedFile)
+  {
+      munmap(mappedFile, mappedSize);
+      mappedFile = nullptr;
+      table = nullptr;
+      return;
+  }
+#endif
+
+  aligned_large_pages_free(table);
+  table = nullptr;
+}
+
+
+/// TranspositionTable::save() writes the table to a file, so that it can be
+/// loaded or mapped again by a later run. Returns false on I/O errors.
+
+bool TranspositionTable::save(const std::string& fileName) const {
+
+  Threads.main()->wait_for_search_finished();
+
+  TTFileHeader header = {};
+  std::memcpy(header.magic, TTFileMagic, sizeof(TTFileMagic));
+  header.clusterSize = sizeof(Cluster);
+  header.clusterCount = clusterCount;
+  header.generation8 = generation8;
+  header.entrySize = sizeof(TTEntry);
+
+  std::ofstream stream(fileName, std::ios::binary);
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  stream.write(reinterpret_cast<const char*>(table), std::streamsize(clusterCount * sizeof(Cluster)));
+
+  return bool(stream);
+}
+
+
+/// TranspositionTable::load() reads a table written by save() into memory,
+/// resizing the table to the size of the saved one.
+
+bool TranspositionTable::load(const std::string& fileName) {
+
+  Threads.main()->wait_for_search_finished();
+
+  TTFileHeader header;
+  std::ifstream stream(fileName, std::ios::binary);
+  if (   !stream.read(reinterpret_cast<char*>(&header), sizeof(header))
+      || !valid_header(header, sizeof(Cluster)))
+      return false;
+
+  free();
+
+  clusterCount = header.clusterCount;
+  table = static_cast<Cluster*>(aligned_large_pages_alloc(clusterCount * sizeof(Cluster)));
+  if (!table)
+  {
+      std::cerr << "Failed to allocate " << clusterCount * sizeof(Cluster) / (1024 * 1024)
+                << "MB for transposition table." << std::endl;
+      exit(EXIT_FAILURE);
+  }
+
+  generation8 = header.generation8;
+  if (!stream.read(reinterpret_cast<char*>(table), std::streamsize(clusterCount * sizeof(Cluster))))
+  {
+      clear();
+      return false;
+  }
+
+  sourceFile = fileName;
+  return true;
+}
+
+
+/// TranspositionTable::map() uses a file written by save() as the table
+/// without copying it. The mapping is private: the search writes into its
+/// own copy of the touched pages and the file itself is left unchanged until
+/// it is saved again. Where mmap() is not available the file is loaded.
+
+bool TranspositionTable::map(const std::string& fileName) {
+
+#ifdef USE_MMAP
+  Threads.main()->wait_for_search_finished();
+
+  int fd = open(fileName.c_str(), O_RDONLY);
+  if (fd == -1)
+      return false;
+
+  struct stat st;
+  TTFileHeader header;
+  if (   fstat(fd, &st) == -1
+      || read(fd, &header, sizeof(header)) != ssize_t(sizeof(header))
+      || !valid_header(header, sizeof(Cluster))
+      || size_t(st.st_size) != sizeof(header) + header.clusterCount * sizeof(Cluster))
+  {
+      close(fd);
+      return false;
+  }
+
+  void* data = mmap(nullptr, size_t(st.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+      return false;
+
+  free();
+
+  mappedFile = data;
+  mappedSize = size_t(st.st_size);
+  clusterCount = header.clusterCount;
+  table = reinterpret_cast<Cluster*>(static_cast<char*>(data) + sizeof(header));
+  generation8 = header.generation8;
+  sourceFile = fileName;
+
+  return true;
+#else
+  return load(fileName);
+#endif
+}
+
+
+/// TranspositionTable::reload() reads again the file the table was loaded or
+/// mapped from, dropping what the searches wrote since. Returns false if the
+/// table does not come from a file or the file cannot be read anymore.
+
+bool TranspositionTable::reload() {
+
+  const std::string fileName = sourceFile;
+
+  if (fileName.empty())
+      return false;
+
+  return mappedFile ? map(fileName) : load(fileName);
+}
+
+
 /// TranspositionTable::clear() initializes the entire transposition table to zero,
-//  in a multi-threaded way.
+//  in a multi-threaded way. By default it uses as many threads as the search.
 
 void TranspositionTable::clear() {
 
+  clear(size_t(Options["Threads"]));
+}
+
+void TranspositionTable::clear(size_t threadCount) {
+
   std::vector<std::thread> threads;
 
-  for (size_t idx = 0; idx < Options["Threads"]; ++idx)
+  for (size_t idx = 0; idx < threadCount; ++idx)
   {
-      threads.emplace_back([this, idx]() {
+      threads.emplace_back([this, idx, threadCount]() {
 
           // Thread binding gives faster search on systems with a first-touch policy
-          if (Options["Threads"] > 8)
+          if (threadCount > 8)
               WinProcGroup::bindThisThread(idx);
 
+          // With the "local" policy each part of the table is first touched,
+          // and so allocated, on the node of the search thread with this index
+          if (Options["NUMA Policy"] == "local")
+              Numa::bind_this_thread(idx);
+
           // Each thread will zero its part of the hash table
-          const size_t stride = size_t(clusterCount / Options["Threads"]),
+          const size_t stride = size_t(clusterCount / threadCount),
                        start  = size_t(stride * idx),
-                       len    = idx != Options["Threads"] - 1 ?
+                       len    = idx != threadCount - 1 ?
                                 stride : clusterCount - start;
 
-          std::memset(&table[start], 0, len * sizeof(Cluster));
+          std::memset(static_cast<void*>(&table[start]), 0, len * sizeof(Cluster));
       });
   }
 
   for (std::thread& th : threads)
       th.join();
+
+#ifdef URBINO_TT
+  STATS(collisions = 0);
+#endif
 }
 
 
@@ -118,13 +490,30 @@ void TranspositionTable::clear() {
 /// TTEntry t2 if its replace value is greater than that of t2.
 
 TTEntry* TranspositionTable::probe(const Key key, bool& found) const {
+  return probe(first_entry(key), key, found);
+}
+
+TTEntry* TranspositionTable::probe(TTEntry* const tte, const Key key, bool& found) const {
 
-  TTEntry* const tte = first_entry(key);
   const uint16_t key16 = (uint16_t)key;  // Use the low 16 bits as key inside the cluster
 
+#ifdef URBINO_TT
+  // Check the extra key bits too. Builds with stats=yes count the entries
+  // that a 16 bit key check alone would have wrongly accepted.
+  const uint32_t keyExt = reinterpret_cast<const Cluster*>(tte)->keyExt.load(std::memory_order_relaxed);
+  const uint32_t ext = uint32_t(key >> 16) & ((1 << KeyExtBits) - 1);
+#endif
+
   for (int i = 0; i < ClusterSize; ++i)
       if (tte[i].key16 == key16 || !tte[i].depth8)
       {
+#ifdef URBINO_TT
+          if (tte[i].depth8 && ((keyExt >> (i * KeyExtBits)) & ((1 << KeyExtBits) - 1)) != ext)
+          {
+              STATS(collisions.fetch_add(1, std::memory_order_relaxed));
+              continue;
+          }
+#endif
           tte[i].genBound8 = uint8_t(generation8 | (tte[i].genBound8 & (GENERATION_DELTA - 1))); // Refresh
 
           return found = (bool)tte[i].depth8, &tte[i];
@@ -159,4 +548,170 @@ int TranspositionTable::hashfull() const {
   return cnt / ClusterSize;
 }
 
+
+/// TTCache::resize() puts the cache in front of a table, sets its size in
+/// kilobytes and its policy, and empties it. The size is rounded down to a
+/// power of 2 of clusters.
+
+void TTCache::resize(const TranspositionTable& table, size_t kbSize, Policy p) {
+
+  tt = &table;
+  std_aligned_free(clusters);
+  clusters = nullptr;
+  clusterCount = 0;
+  enabledCount += (p != OFF) - (policy != OFF);
+  policy = p;
+
+  if (policy != OFF)
+  {
+      clusterCount = 1;
+      while (clusterCount * 2 * sizeof(Cluster) <= kbSize * 1024)
+          clusterCount *= 2;
+
+      clusters = static_cast<Cluster*>(std_aligned_alloc(sizeof(Cluster), clusterCount * sizeof(Cluster)));
+  }
+
+  clear();
+}
+
+
+/// TTCache::clear() empties the cache, dropping unwritten entries, and resets
+/// the statistics.
+
+void TTCache::clear() {
+
+  if (clusters)
+      std::memset(static_cast<void*>(clusters), 0, clusterCount * sizeof(Cluster));
+
+  keys.assign(clusterCount * TranspositionTable::ClusterSize, 0);
+  dirty.assign(clusterCount * TranspositionTable::ClusterSize, false);
+  std::fill(std::begin(probes), std::end(probes), 0);
+  std::fill(std::begin(hits), std::end(hits), 0);
+}
+
+
+/// TTCache::flush() writes the unwritten entries back to the TT
+
+void TTCache::flush() {
+
+  for (size_t i = 0; i < dirty.size(); ++i)
+      if (dirty[i])
+      {
+          bool found;
+          TTEntry& e = clusters[i / TranspositionTable::ClusterSize].entry[i % TranspositionTable::ClusterSize];
+          tt->probe(keys[i], found)->save(keys[i], e);
+          dirty[i] = false;
+      }
+}
+
+
+/// TTCache::probe() looks up a position like TranspositionTable::probe(), but
+/// in the cache first. On a miss, the least valuable cache entry is written
+/// back if needed and replaced by the TT entry of the position, if any.
+
+TTEntry* TTCache::probe(const Key key, bool& found, Depth depth) {
+
+  const int level = std::max(int(depth), 0);
+  TTEntry* const tte = &clusters[mul_hi64(key, clusterCount)].entry[0];
+  TTEntry* replace = tt->probe(tte, key, found);
+  const size_t idx = index_of(replace);
+
+  ++probes[level];
+  if (found && keys[idx] == key)
+      return ++hits[level], replace;
+
+  if (dirty[idx] && replace->depth8)
+  {
+      bool written;
+      tt->probe(keys[idx], written)->save(keys[idx], *replace);
+  }
+
+  // Fill the entry from the TT, or leave it empty. The entry may hold another
+  // position with the same key16, so it is overwritten whatever it holds.
+  bool shared;
+  const TTEntry* e = tt->probe(key, shared);
+  if (shared)
+      replace->copy(key, *e);
+  else
+      replace->depth8 = 0;
+
+  keys[idx] = key;
+  dirty[idx] = false;
+
+  return found = shared, replace;
+}
+
+
+/// TTCache::saved() is called after an entry of the cache has been saved and
+/// passes the data on to the TT according to the policy.
+
+void TTCache::saved(const TTEntry* tte, Key k, Value v, bool pv, Bound b, Depth d, Move m, Value ev, const Position& pos) {
+
+  if (!contains(tte))
+      return;
+
+  // A probe further down the tree may have given the entry to another
+  // position since it was probed. TTEntry::save() then overwrote it, as
+  // stale() told it, so the entry now holds this position.
+  keys[index_of(tte)] = k;
+
+  if (policy == WRITE_THROUGH)
+  {
+      bool found;
+      tt->probe(k, found)->save(k, v, pv, b, d, m, ev, pos);
+  }
+  else
+      dirty[index_of(tte)] = true;
+}
+
+
+/// TranspositionTable::stats() describes the entry layout and how the whole
+/// table is used, for the "tt stats" command. With URBINO_TT and stats=yes it
+/// also reports the key collisions caught by the extra key bits since the
+/// last clear.
+
+std::string TranspositionTable::stats() const {
+
+  size_t used = 0, current = 0;
+  for (size_t i = 0; i < clusterCount; ++i)
+      for (int j = 0; j < ClusterSize; ++j)
+          if (table[i].entry[j].depth8)
+          {
+              ++used;
+              current += (table[i].entry[j].genBound8 & GENERATION_MASK) == generation8;
+          }
+
+  const size_t entries = clusterCount * ClusterSize;
+  std::stringstream ss;
+  ss << "Entry size      : " << sizeof(TTEntry) << " bytes"
+     << "\nEntries/cluster : " << ClusterSize
+     << "\nEntries         : " << entries
+     << "\nUsed            : " << used * 1000 / entries << " permill"
+     << "\nHashfull        : " << current * 1000 / entries << " permill"
+#ifdef URBINO_TT
+     << "\nKey bits        : " << 16 + KeyExtBits
+     STATS(<< "\nCollisions      : " << collisions.load(std::memory_order_relaxed)
+           << " (accepted by a 16 bit key check)")
+#else
+     << "\nKey bits        : " << 16
+#endif
+     ;
+
+  // Hit rates of the per-thread caches, by depth
+  uint64_t probes[TTCache::LEVEL_NB] = {}, hits[TTCache::LEVEL_NB] = {};
+  for (Thread* th : Threads)
+      for (int level = 0; level < TTCache::LEVEL_NB; ++level)
+      {
+          probes[level] += th->ttCache.probes[level];
+          hits[level] += th->ttCache.hits[level];
+      }
+
+  for (int level = 0; level < TTCache::LEVEL_NB; ++level)
+      if (probes[level])
+          ss << "\nCache depth " << level << "   : " << hits[level] * 100 / probes[level]
+             << "% hits of " << probes[level] << " probes";
+
+  return ss.str();
+}
+
 } // namespace Stockfish
@@ -19,11 +19,18 @@
 #ifndef TT_H_INCLUDED
 #define TT_H_INCLUDED
 
+#include <atomic>
+#include <string>
+#include <vector>
+
 #include "misc.h"
+#include "stats.h"
 #include "types.h"
 
 namespace Stockfish {
 
+class Position;
+
 /// TTEntry struct is the 12 bytes transposition table entry, defined as below:
 ///
 /// key        16 bit
@@ -34,28 +41,45 @@ namespace Stockfish {
 /// move       32 bit (official SF: 16 bit)
 /// value      16 bit
 /// eval value 16 bit
+///
+/// Builds with URBINO_TT use a 10 bytes entry instead: the move is packed into
+/// 16 bits (see pack_move() in tt.cpp), which is enough for Urbino moves once
+/// the architect that moves is reduced to one bit. Moves of other variants
+/// are not stored. The position is needed to pack and unpack the move.
 
 struct TTEntry {
 
-  Move  move()  const { return (Move )move32; }
+  Move  move(const Position& pos) const;
   Value value() const { return (Value)value16; }
   Value eval()  const { return (Value)eval16; }
   Depth depth() const { return (Depth)depth8 + DEPTH_OFFSET; }
   bool is_pv()  const { return (bool)(genBound8 & 0x4); }
   Bound bound() const { return (Bound)(genBound8 & 0x3); }
-  void save(Key k, Value v, bool pv, Bound b, Depth d, Move m, Value ev);
+  void save(Key k, Value v, bool pv, Bound b, Depth d, Move m, Value ev, const Position& pos);
 
 private:
   friend class TranspositionTable;
+  friend class TTCache;
+
+  void save(Key k, const TTEntry& e);
+  void copy(Key k, const TTEntry& e);
 
   uint16_t key16;
   uint8_t  depth8;
   uint8_t  genBound8;
+#ifdef URBINO_TT
+  uint16_t move16;
+#else
   uint32_t move32;
+#endif
   int16_t  value16;
   int16_t  eval16;
 };
 
+#ifndef URBINO_TT
+inline Move TTEntry::move(const Position&) const { return (Move)move32; }
+#endif
+
 
 /// A TranspositionTable is an array of Cluster, of size clusterCount. Each
 /// cluster consists of ClusterSize number of TTEntry. Each non-empty TTEntry
@@ -65,12 +89,25 @@ private:
 
 class TranspositionTable {
 
+#ifdef URBINO_TT
+  static constexpr int ClusterSize = 6;
+  static constexpr int KeyExtBits = 5;
+
+  // The spare bytes of a cluster hold 5 more key bits for each entry, so
+  // that together with key16 a 21 bit key is checked. The word is shared by
+  // the entries of the cluster, so it is only updated atomically.
+  struct Cluster {
+    TTEntry entry[ClusterSize];
+    std::atomic<uint32_t> keyExt;
+  };
+#else
   static constexpr int ClusterSize = 5;
 
   struct Cluster {
     TTEntry entry[ClusterSize];
     char padding[4]; // Pad to 64 bytes
   };
+#endif
 
   static_assert(sizeof(Cluster) == 64, "Unexpected Cluster size");
 
@@ -81,12 +118,19 @@ class TranspositionTable {
   static constexpr int      GENERATION_MASK  = (0xFF << GENERATION_BITS) & 0xFF; // mask to pull out generation number
 
 public:
- ~TranspositionTable() { aligned_large_pages_free(table); }
+ ~TranspositionTable() { free(); }
   void new_search() { generation8 += GENERATION_DELTA; } // Lower bits are used for other things
   TTEntry* probe(const Key key, bool& found) const;
   int hashfull() const;
   void resize(size_t mbSize);
   void clear();
+  void clear(size_t threadCount);
+  bool save(const std::string& fileName) const;
+  bool load(const std::string& fileName);
+  bool map(const std::string& fileName);
+  bool reload();
+  std::string stats() const;
+  size_t size_mb() const { return clusterCount * sizeof(Cluster) / (1024 * 1024); }
 
   TTEntry* first_entry(const Key key) const {
     return &table[mul_hi64(key, clusterCount)].entry[0];
@@ -94,14 +138,95 @@ public:
 
 private:
   friend struct TTEntry;
+  friend class TTCache;
 
-  size_t clusterCount;
-  Cluster* table;
-  uint8_t generation8; // Size must be not bigger than TTEntry::genBound8
+  TTEntry* probe(TTEntry* const tte, const Key key, bool& found) const;
+  void free();
+
+#ifdef URBINO_TT
+  static std::atomic<uint32_t>& key_ext(const TTEntry* tte, int& shift) {
+    Cluster* cluster = reinterpret_cast<Cluster*>(uintptr_t(tte) & ~uintptr_t(sizeof(Cluster) - 1));
+    shift = int(tte - cluster->entry) * KeyExtBits;
+    return cluster->keyExt;
+  }
+
+  // set_key_ext() replaces the key bits of one entry without losing a
+  // concurrent update of the other entries of the cluster
+  static void set_key_ext(std::atomic<uint32_t>& keyExt, int shift, uint32_t ext) {
+    const uint32_t mask = ((1 << KeyExtBits) - 1) << shift;
+    uint32_t old = keyExt.load(std::memory_order_relaxed);
+    while (!keyExt.compare_exchange_weak(old, (old & ~mask) | (ext << shift), std::memory_order_relaxed)) {}
+  }
+
+  STATS(mutable std::atomic<uint64_t> collisions;)
+#endif
+
+  size_t clusterCount = 0;
+  Cluster* table = nullptr;
+  void* mappedFile = nullptr;
+  size_t mappedSize = 0;
+  std::string sourceFile; // File the table was loaded or mapped from, if any
+  uint8_t generation8 = 0; // Size must be not bigger than TTEntry::genBound8
 };
 
 extern TranspositionTable TT;
 
+
+/// TTCache is a small private table that each search thread can put in front
+/// of the shared TT for the nodes close to the leaves, where most probes
+/// happen and the shared cache lines are the most contended. It uses the
+/// clusters and replacement scheme of the TT. A miss fills the entry from the
+/// TT. Saves into the cache reach the TT either at once (write-through) or
+/// when the entry is evicted or the search ends (write-back).
+
+class TTCache {
+
+  typedef TranspositionTable::Cluster Cluster;
+
+public:
+  enum Policy { OFF, WRITE_THROUGH, WRITE_BACK };
+
+  // Nodes up to this depth use the cache. Level 0 is quiescence search.
+  static constexpr Depth MaxDepth = 2;
+  static constexpr int LEVEL_NB = MaxDepth + 1;
+
+ ~TTCache() { std_aligned_free(clusters); enabledCount -= policy != OFF; }
+  void resize(const TranspositionTable& table, size_t kbSize, Policy p);
+  void clear();
+  void flush();
+  TTEntry* probe(const Key key, bool& found, Depth depth);
+  bool enabled(Depth depth) const { return policy != OFF && depth <= MaxDepth; }
+  void saved(const TTEntry* tte, Key k, Value v, bool pv, Bound b, Depth d, Move m, Value ev, const Position& pos);
+
+  // stale() tells whether an entry of this cache was given to another position
+  // than k since it was probed
+  bool stale(const TTEntry* tte, Key k) const { return contains(tte) && keys[index_of(tte)] != k; }
+
+  // The cache of the calling search thread, if any, and the number of caches
+  // whose policy is not OFF
+  static thread_local TTCache* local;
+  static std::atomic<int> enabledCount;
+
+  uint64_t probes[LEVEL_NB], hits[LEVEL_NB];
+
+private:
+  bool contains(const TTEntry* tte) const {
+    return clusters && uintptr_t(tte) - uintptr_t(clusters) < clusterCount * sizeof(Cluster);
+  }
+
+  size_t index_of(const TTEntry* tte) const {
+    const size_t c = (uintptr_t(tte) - uintptr_t(clusters)) / sizeof(Cluster);
+    return c * TranspositionTable::ClusterSize + size_t(tte - clusters[c].entry);
+  }
+
+  Policy policy = OFF;
+  const TranspositionTable* tt = nullptr; // The table the cache is in front of
+  size_t clusterCount = 0;
+  Cluster* clusters = nullptr;
+  std::vector<Key> keys;
+  std::vector<bool> dirty;
+};
+
 } // namespace Stockfish
 
 #endif // #ifndef TT_H_INCLUDED
@@ -31,6 +31,9 @@ namespace Stockfish {
 bool Tune::update_on_last;
 const UCI::Option* LastOption = nullptr;
 static std::map<std::string, int> TuneResults;
+static std::vector<Tune::Param> TuneParams;
+
+const std::vector<Tune::Param>& Tune::params() { return TuneParams; }
 
 string Tune::next(string& names, bool pop) {
 
@@ -68,6 +71,7 @@ static void make_option(const string& n, int v, const SetRange& r) {
 
   Options[n] << UCI::Option(v, r(v).first, r(v).second, on_tune);
   LastOption = &Options[n];
+  TuneParams.push_back({ n, r(v) });
 
   // Print formatted parameters, ready to be copy-pasted in Fishtest
   std::cout << n << ","
@@ -92,6 +96,15 @@ template<> void Tune::Entry<Value>::read_option() {
       value = Value(int(Options[name]));
 }
 
+#ifdef USE_TUNE
+template<> void Tune::Entry<Tunable>::init_option() { make_option(name, value.value, range); }
+
+template<> void Tune::Entry<Tunable>::read_option() {
+  if (Options.count(name))
+      value.value = int(Options[name]);
+}
+#endif
+
 template<> void Tune::Entry<Score>::init_option() {
   make_option("m" + name, mg_value(value), range);
   make_option("e" + name, eg_value(value), range);
@@ -109,6 +122,34 @@ template<> void Tune::Entry<Score>::read_option() {
 template<> void Tune::Entry<Tune::PostUpdate>::init_option() {}
 template<> void Tune::Entry<Tune::PostUpdate>::read_option() { value(); }
 
+static bool same_name(const string& a, const string& b) {
+  return !UCI::CaseInsensitiveLess()(a, b) && !UCI::CaseInsensitiveLess()(b, a);
+}
+
+std::vector<int> Tune::values(const std::vector<std::pair<string, string>>& given) {
+
+  std::vector<int> v;
+
+  for (const auto& [name, value] : instance().tunables)
+  {
+      v.push_back(*value);
+      for (const auto& g : given)
+          if (same_name(g.first, name))
+              std::istringstream(g.second) >> v.back();
+  }
+
+  return v;
+}
+
+bool Tune::is_tunable(const string& name) {
+
+  for (const auto& t : instance().tunables)
+      if (same_name(t.first, name))
+          return true;
+
+  return false;
+}
+
 } // namespace Stockfish
 
 
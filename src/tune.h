@@ -46,6 +46,24 @@ struct SetRange {
 #define SetDefaultRange SetRange(default_range)
 
 
+#ifdef USE_TUNE
+
+/// Tunable is the type of the TUNABLE parameters in builds with tune=yes. It
+/// reads like an int, and the search threads of a private pool can override
+/// its value (see Tune::local), so that the spsa games between different
+/// values can run side by side.
+
+struct Tunable {
+  Tunable(int v) : value(v) {}
+  inline operator int() const;
+
+  int value;
+  int index = -1; // Index in the values of Tune::local, set by TUNE()
+};
+
+#endif
+
+
 /// Tune class implements the 'magic' code that makes the setup of a fishtest
 /// tuning session as easy as it can be. Mainly you have just to remove const
 /// qualifiers from the variables you want to tune and flag them for tuning, so
@@ -99,6 +117,9 @@ class Tune {
     static_assert(   std::is_same<T,   int>::value
                   || std::is_same<T, Value>::value
                   || std::is_same<T, Score>::value
+#ifdef USE_TUNE
+                  || std::is_same<T, Tunable>::value
+#endif
                   || std::is_same<T, PostUpdate>::value, "Parameter type not supported!");
 
     Entry(const std::string& n, T& v, const SetRange& r) : name(n), value(v), range(r) {}
@@ -132,6 +153,17 @@ class Tune {
     return add(range, std::move(names), args...);
   }
 
+#ifdef USE_TUNE
+  // Template specialization for Tunable, which also gets its index
+  template<typename... Args>
+  int add(const SetRange& range, std::string&& names, Tunable& value, Args&&... args) {
+    value.index = int(tunables.size());
+    tunables.push_back({ next(names, false), &value.value });
+    list.push_back(std::unique_ptr<EntryBase>(new Entry<Tunable>(next(names), value, range)));
+    return add(range, std::move(names), args...);
+  }
+#endif
+
   // Template specialization for SetRange
   template<typename... Args>
   int add(const SetRange&, std::string&& names, SetRange& value, Args&&... args) {
@@ -139,8 +171,27 @@ class Tune {
   }
 
   std::vector<std::unique_ptr<EntryBase>> list;
+  std::vector<std::pair<std::string, int*>> tunables; // Name and global value
 
 public:
+  // Name and range of an option created for a parameter
+  struct Param {
+    std::string name;
+    Range range;
+  };
+
+  static const std::vector<Param>& params();
+
+  // values() returns the values of the TUNABLE parameters for a private pool:
+  // the given values by name, else the global ones. is_tunable() tells
+  // whether an option belongs to a TUNABLE parameter.
+  static std::vector<int> values(const std::vector<std::pair<std::string, std::string>>& given);
+  static bool is_tunable(const std::string& name);
+
+  // Values of the TUNABLE parameters for the calling search thread, or
+  // nullptr to use their global values. Only read in builds with tune=yes.
+  static inline thread_local const int* local = nullptr;
+
   template<typename... Args>
   static int add(const std::string& names, Args&&... args) {
     return instance().add(SetDefaultRange, names.substr(1, names.size() - 2), args...); // Remove trailing parenthesis
@@ -150,12 +201,27 @@ public:
   static bool update_on_last;
 };
 
+#ifdef USE_TUNE
+inline Tunable::operator int() const { return Tune::local ? Tune::local[index] : value; }
+#endif
+
 // Some macro magic :-) we define a dummy int variable that compiler initializes calling Tune::add()
 #define STRINGIFY(x) #x
 #define UNIQUE2(x, y) x ## y
 #define UNIQUE(x, y) UNIQUE2(x, y) // Two indirection levels to expand __LINE__
+
 #define TUNE(...) int UNIQUE(p, __LINE__) = Tune::add(STRINGIFY((__VA_ARGS__)), __VA_ARGS__)
 
+// TUNABLE parameters are compile time constants, unless the build has
+// tune=yes (USE_TUNE). Only then TUNE_TUNABLE() registers them like TUNE().
+#ifdef USE_TUNE
+#define TUNABLE Tunable
+#define TUNE_TUNABLE(...) TUNE(__VA_ARGS__)
+#else
+#define TUNABLE constexpr int
+#define TUNE_TUNABLE(...) static_assert(true, "")
+#endif
+
 #define UPDATE_ON_LAST() bool UNIQUE(p, __LINE__) = Tune::update_on_last = true
 
 } // namespace Stockfish
@@ -19,14 +19,20 @@
 #include <cstdlib>
 #include <cassert>
 #include <cmath>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <string>
 
+#include "book.h"
 #include "evaluate.h"
 #include "movegen.h"
+#include "playout.h"
 #include "position.h"
 #include "search.h"
+#include "selfplay.h"
+#include "stats.h"
 #include "thread.h"
 #include "timeman.h"
 #include "tt.h"
@@ -39,6 +45,8 @@ using namespace std;
 namespace Stockfish {
 
 extern vector<string> setup_bench(const Position&, istream&);
+extern void microbench(istream&);
+extern void bench_compare(istream&);
 
 namespace {
 
@@ -176,17 +184,36 @@ namespace {
 
   // bench() is called when engine receives the "bench" command. Firstly
   // a list of UCI commands is setup according to bench parameters, then
-  // it is run one by one printing a summary at the end.
+  // it is run one by one printing a summary at the end. With "json <file>"
+  // among the parameters, the results of each position are also appended to
+  // the file as a single line of JSON, so repeated runs can be compared with
+  // "bench compare <old> <new>".
 
   void bench(Position& pos, istream& args, StateListPtr& states) {
 
-    string token;
+    string token, jsonFile, benchArgs;
     uint64_t num, nodes = 0, cnt = 1, signature = 0;
 
-    vector<string> list = setup_bench(pos, args);
+    while (args >> token)
+        if (token == "compare")
+        {
+            bench_compare(args);
+            return;
+        }
+        else if (token == "json")
+            args >> jsonFile;
+        else
+            benchArgs += token + " ";
+
+    istringstream setupArgs(benchArgs);
+    vector<string> list = setup_bench(pos, setupArgs);
     num = count_if(list.begin(), list.end(), [](string s) { return s.find("go ") == 0 || s.find("eval") == 0; });
 
+    PerfCounters perf;
+    STATS(uint64_t movesGenerated = 0);
+    stringstream positions;
     TimePoint elapsed = now();
+    perf.start();
 
     for (const auto& cmd : list)
     {
@@ -198,23 +225,35 @@ namespace {
             cerr << "\nPosition: " << cnt++ << '/' << num << " (" << pos.fen() << ")" << endl;
             if (token == "go")
             {
+               string fen = pos.fen();
+               TimePoint start = now();
                go(pos, is, states);
                Threads.main()->wait_for_search_finished();
+               TimePoint time = now() - start;
                nodes += Threads.nodes_searched();
 
+               positions << (positions.tellp() > 0 ? ", " : "") << "{\"fen\": \"" << fen << "\""
+                         << ", \"nodes\": " << Threads.nodes_searched()
+                         << ", \"time\": " << time
+                         << ", \"nps\": " << 1000 * Threads.nodes_searched() / std::max(time, TimePoint(1))
+                         << ", \"depth\": " << Threads.main()->completedDepth
+                         << ", \"hashfull\": " << TT.hashfull() << "}";
+               STATS(for (Thread* th : Threads) movesGenerated += th->stats.movesGenerated);
+
                // Accumulate signature from bestmove
-               if (!Threads.main()->rootMoves.empty())
-                   signature ^= Threads.main()->rootMoves[0].pv[0] + nodes + cnt;
+               if (!Threads.main()->rootLines.empty())
+                   signature ^= Threads.main()->rootLines[0].move() + nodes + cnt;
             }
             else
                trace_eval(pos);
         }
         else if (token == "setoption")  setoption(is);
         else if (token == "position")   position(pos, is, states);
-        else if (token == "ucinewgame") { Search::clear(); elapsed = now(); } // Search::clear() may take some while
+        else if (token == "ucinewgame") { Search::clear(); elapsed = now(); perf.start(); } // Search::clear() may take some while
     }
 
     elapsed = now() - elapsed + 1; // Ensure positivity to avoid a 'divide by zero'
+    perf.stop();
 
     dbg_print(); // Just before exiting
 
@@ -223,6 +262,48 @@ namespace {
          << "\nNodes searched  : " << nodes
          << "\nNodes/second    : " << 1000 * nodes / elapsed
          << "\nSignature       : " << signature << endl;
+
+    // Hardware counters per node, when the system lets us read them
+    if (perf.available() && nodes)
+    {
+        const char* names[] = { "Cycles/node     : ", "Instr/node      : ", "L1d misses/node : ",
+                                "LLC misses/node : ", "Branch miss/node: " };
+        cerr << std::fixed << std::setprecision(2);
+        for (int e = 0; e < PerfCounters::EVENT_NB; ++e)
+            if (perf.available(PerfCounters::Event(e)))
+                cerr << names[e] << perf.value(PerfCounters::Event(e)) / nodes << "\n";
+        if (perf.available(PerfCounters::CYCLES) && perf.available(PerfCounters::INSTRUCTIONS))
+            cerr << "Instr/cycle     : " << perf.value(PerfCounters::INSTRUCTIONS) / perf.value(PerfCounters::CYCLES) << "\n";
+#ifdef USE_STATS
+        if (movesGenerated)
+            for (auto e : { PerfCounters::CYCLES, PerfCounters::INSTRUCTIONS })
+                if (perf.available(e))
+                    cerr << (e == PerfCounters::CYCLES ? "Cycles/move gen : " : "Instr/move gen  : ")
+                         << perf.value(e) / movesGenerated << "\n";
+#endif
+        cerr << std::defaultfloat << std::flush;
+    }
+
+    if (!jsonFile.empty())
+    {
+        const char* events[] = { "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses" };
+        ofstream file(jsonFile, ios::app);
+        file << "{\"engine\": \"" << engine_info(false, true) << "\""
+             << ", \"variant\": \"" << string(Options["UCI_Variant"]) << "\""
+             << ", \"threads\": " << Threads.size()
+             << ", \"hash\": " << int(Options["Hash"])
+             << ", \"nodes\": " << nodes
+             << ", \"time\": " << elapsed
+             << ", \"nps\": " << 1000 * nodes / elapsed
+             << ", \"signature\": " << signature;
+        for (int e = 0; e < PerfCounters::EVENT_NB; ++e)
+            if (perf.available(PerfCounters::Event(e)))
+                file << ", \"" << events[e] << "\": " << uint64_t(perf.value(PerfCounters::Event(e)));
+        file << ", \"positions\": [" << positions.str() << "]}" << endl;
+
+        if (!file)
+            cerr << "Unable to write " << jsonFile << endl;
+    }
   }
 
   // The win rate model returns the probability (per mille) of winning given an eval
@@ -396,6 +477,42 @@ void UCI::loop(int argc, char* argv[]) {
       // Do not use these commands during a search!
       else if (token == "flip")     pos.flip();
       else if (token == "bench")    bench(pos, is, states);
+      else if (token == "playouts") UrbinoPlayout::bench(pos, is);
+      else if (token == "microbench") microbench(is);
+      else if (token == "generate_training_data") SelfPlay::generate_training_data(pos, is);
+      else if (token == "selfplay") SelfPlay::match(pos, is);
+      else if (token == "spsa")     SelfPlay::spsa(pos, is);
+      else if (token == "fuzz")     SelfPlay::fuzz(pos, is);
+      else if (token == "tt")
+      {
+          std::string action, fileName;
+          is >> action >> fileName;
+          if (action == "save" && !fileName.empty())
+              sync_cout << (TT.save(fileName) ? "info string Saved TT to " : "info string Could not save TT to ")
+                        << fileName << sync_endl;
+          else if (action == "load" && !fileName.empty())
+          {
+              bool loaded = TT.load(fileName);
+              if (loaded)
+                  Options["Hash"] = std::to_string(TT.size_mb()); // Table is kept, see on_hash_size()
+              sync_cout << (loaded ? "info string Loaded TT from " : "info string Could not load TT from ")
+                        << fileName << sync_endl;
+          }
+          else if (action == "stats")
+              sync_cout << TT.stats() << sync_endl;
+          else
+              sync_cout << "Usage: tt save|load <file> | tt stats" << sync_endl;
+      }
+      else if (token == "stats")    sync_cout << SearchStats::json() << sync_endl;
+      else if (token == "book")
+      {
+          std::string action;
+          is >> action;
+          if (action == "build")
+              Book::build(pos, is);
+          else
+              sync_cout << "Usage: book build <file> [plies] [width] [depth]" << sync_endl;
+      }
       else if (token == "d")        sync_cout << pos << sync_endl;
       else if (token == "eval")     trace_eval(pos);
       else if (token == "urbino" && pos.urbino_gating()) {
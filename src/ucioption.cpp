@@ -22,6 +22,7 @@
 #include <sstream>
 #include <iostream>
 
+#include "book.h"
 #include "evaluate.h"
 #include "misc.h"
 #include "piece.h"
@@ -59,9 +60,28 @@ void init_variant(const Variant* v) {
 
 /// 'On change' actions, triggered by an option's value change
 void on_clear_hash(const Option&) { Search::clear(); }
-void on_hash_size(const Option& o) { TT.resize(size_t(o)); }
+void on_hash_size(const Option& o) { if (size_t(o) != TT.size_mb()) TT.resize(size_t(o)); }
+void on_tt_file(const Option& o) {
+    if (std::string(o) == "<empty>")
+        return;
+    if (TT.map(o))
+        Options["Hash"] = std::to_string(TT.size_mb()); // Table is kept, see on_hash_size()
+    else
+        sync_cout << "info string Could not map TT file " << std::string(o) << sync_endl;
+}
+void on_book_file(const Option& o) {
+    if (!Book::init(o))
+        sync_cout << "info string Could not load book file " << std::string(o) << sync_endl;
+}
 void on_logger(const Option& o) { start_logger(o); }
 void on_threads(const Option& o) { Threads.set(size_t(o)); }
+void on_bind_threads(const Option&) { Threads.set(size_t(Options["Threads"])); }
+void on_numa_policy(const Option&) { TT.resize(size_t(Options["Hash"])); }
+void on_tt_cache(const Option&) {
+    Threads.main()->wait_for_search_finished();
+    for (Thread* th : Threads)
+        th->clear();
+}
 void on_tb_path(const Option& o) { Tablebases::init(o); }
 
 void on_use_NNUE(const Option& ) { Eval::NNUE::init(); }
@@ -83,6 +103,7 @@ void on_variant_set(const Option &o) {
     const Variant* v = variants.find(o)->second;
     init_variant(v);
     PSQT::init(v);
+    Eval::clear_cache();
 }
 void on_variant_change(const Option &o) {
     // Variant initialization
@@ -182,10 +203,19 @@ void init(OptionsMap& o) {
 
   o["Debug Log File"]        << Option("", on_logger);
   o["Threads"]               << Option(1, 1, 512, on_threads);
+  o["Bind Threads"]          << Option(false, on_bind_threads);
   o["Hash"]                  << Option(16, 1, MaxHashMB, on_hash_size);
+  o["NUMA Policy"]           << Option("none", {"none", "interleave", "local"}, on_numa_policy);
   o["Clear Hash"]            << Option(on_clear_hash);
+  o["TT File"]               << Option("<empty>", on_tt_file);
+  o["TT Cache"]              << Option("off", {"off", "write-through", "write-back"}, on_tt_cache);
+  o["TT Cache Size"]         << Option(256, 16, 65536, on_tt_cache);
+  o["Book File"]             << Option("<empty>", on_book_file);
   o["Ponder"]                << Option(false);
+  o["Keep Search State"]     << Option(false);
   o["MultiPV"]               << Option(1, 1, 500);
+  o["SearchMode"]            << Option("AlphaBeta", {"AlphaBeta", "MCTS"});
+  o["MCTS Hash"]             << Option(16, 1, MaxHashMB);
   o["Skill Level"]           << Option(20, -20, 20);
   o["Move Overhead"]         << Option(10, 0, 5000);
   o["Slow Mover"]            << Option(100, 10, 1000);
@@ -93,6 +93,9 @@ namespace {
         // v->passOnStalemate[WHITE] = true;  // Allow pass when no legal moves. This doesn't work. Anyway Urbino doesn't have Kings so really no stalemate.
         // v->passOnStalemate[BLACK] = true;  // Allow pass when no legal moves
         v->extinctionValue = VALUE_NONE;  // Disable extinction for Urbino - no pieces can be captured
+        // NNUE: without a king HalfKAv2 reduces to piece type x color x square for the
+        // buildings and architects, plus one feature per piece in hand (792 inputs).
+        // Networks for it are picked up by file name, e.g. urbino-xxxx.nnue.
         return v;
     }
 #endif
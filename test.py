@@ -1282,7 +1282,59 @@ class TestPyffish(unittest.TestCase):
         fen = "rnbqkbnr/p1p2ppp/8/Pp1pp3/4P3/8/1PPP1PPP/RNBQKBNR w KQkq b6 0 1"
         result = sf.get_fog_fen(fen, "fogofwar")
         self.assertEqual(result, "********/********/2******/Pp*p***1/4P3/4*3/1PPP1PPP/RNBQKBNR w KQkq b6 0 1")
-        
+
+    def test_board(self):
+        moves = ["f2f3", "e7e5", "g2g4"]
+        board = sf.Board("chess", CHESS, moves)
+        self.assertEqual(board.fen(), sf.get_fen("chess", CHESS, moves))
+        self.assertEqual(board.legal_moves(), sf.legal_moves("chess", CHESS, moves))
+        self.assertIsNone(board.result())
+        board.push("d8h4")
+        self.assertEqual(board.result(), -sf.VALUE_MATE)
+        self.assertEqual(board.pop(), "d8h4")
+        self.assertEqual(board.pop(), "g2g4")
+        self.assertEqual(board.fen(), sf.get_fen("chess", CHESS, moves[:2]))
+        with self.assertRaises(ValueError):
+            board.push("e1e3")
+        with self.assertRaises(IndexError):
+            sf.Board("chess").pop()
+        with self.assertRaises(RuntimeError):
+            sf.Board.__new__(sf.Board).legal_moves()
+
+        # play an Urbino game incrementally and compare with replaying it
+        board = sf.Board("urbino")
+        moves = []
+        while board.result() is None and len(moves) < 30:
+            legal = board.legal_moves()
+            self.assertEqual(legal, sf.legal_moves("urbino", "startpos", moves))
+            moves.append(legal[len(moves) * 7 % len(legal)])
+            board.push(moves[-1])
+            self.assertEqual(board.fen(), sf.get_fen("urbino", "startpos", moves))
+        white, black = board.urbino_scores()
+        self.assertGreaterEqual(white, 0)
+        self.assertGreaterEqual(black, 0)
+        while moves:
+            self.assertEqual(board.pop(), moves.pop())
+        self.assertEqual(board.fen(), sf.get_fen("urbino", "startpos", []))
+
+    def test_batch(self):
+        items = [(CHESS, []), (CHESS, ["f2f3", "e7e5", "g2g4", "d8h4"]), ("startpos", ["e2e4"])]
+        result = sf.legal_moves_batch("chess", items)
+        self.assertEqual(result, [sf.legal_moves("chess", fen, moves) for fen, moves in items])
+        result = sf.game_result_batch("chess", items)
+        self.assertEqual(result, [None, -sf.VALUE_MATE, None])
+
+        sf.set_option("Threads", 2)
+        items = [("startpos", []), ("startpos", ["A@e5", "e5c3"])] * 10
+        result = sf.legal_moves_batch("urbino", items)
+        sf.set_option("Threads", 1)
+        self.assertEqual(result, [sf.legal_moves("urbino", fen, moves) for fen, moves in items])
+
+        with self.assertRaises(ValueError):
+            sf.legal_moves_batch("chess", [(CHESS, ["e2e5"])])
+        with self.assertRaises(TypeError):
+            sf.game_result_batch("chess", [CHESS])
+
 
 if __name__ == '__main__':
     unittest.main(verbosity=2)
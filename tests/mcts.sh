@@ -0,0 +1,41 @@
+#!/bin/bash
+# verify the MCTS search mode: terminal nodes, repetitions and tree reuse
+# usage (from the directory of the engine): ../tests/mcts.sh
+# environment: STOCKFISH (default ./stockfish)
+
+STOCKFISH=${STOCKFISH:-./stockfish}
+
+error()
+{
+  echo "mcts testing failed on line $1"
+  exit 1
+}
+trap 'error ${LINENO}' ERR
+
+# mcts <commands> -> output of the engine in MCTS mode, the commands are
+# followed by a pause so that the last search is not stopped by "quit"
+mcts()
+{
+  (printf "setoption name SearchMode value MCTS\nsetoption name UCI_Variant value chess\n%b" "$1"; sleep 2; echo quit) \
+    | $STOCKFISH 2>/dev/null
+}
+
+echo "mcts testing started"
+
+# a mate in one is a terminal node and must be found
+mcts "position fen 6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1\ngo nodes 20000\n" | grep -q "^bestmove a1a8"
+
+# the subtree of the expected reply is reused for the next search
+out=$(mcts "position startpos\ngo nodes 50000\n")
+best=$(sed -n 's/^bestmove \([^ ]*\) ponder \([^ ]*\).*/\1 \2/p' <<< "$out")
+[[ -n "$best" ]]
+out=$(mcts "position startpos\ngo nodes 50000\nposition startpos moves $best\ngo nodes 50000\n")
+playouts=$(sed -n 's/^info string MCTS reusing subtree of \([0-9]*\) playouts/\1/p' <<< "$out")
+[[ -n "$playouts" && $playouts -gt 10 ]]
+
+# repetitions in the reused tree must not make the new root a terminal node
+out=$(mcts "position startpos moves g1f3 g8f6\ngo nodes 50000\nposition startpos moves g1f3 g8f6 f3g1 f6g8\ngo nodes 50000\n")
+pv=$(grep "^info depth" <<< "$out" | tail -1 | sed 's/.* pv //')
+[[ $(wc -w <<< "$pv") -gt 1 ]]
+
+echo "mcts testing OK"
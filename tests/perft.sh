@@ -197,6 +197,11 @@ if [[ $1 == "all" ||  $1 == "largeboard" ]]; then
   expect perft.exp flipello10 startpos 7 55180 > /dev/null
 fi
 
+# urbino and monuments, also checking the move hashes
+if [[ $1 == "all" || $1 == "urbino" ]]; then
+  "$(dirname "$0")"/perft_urbino.sh
+fi
+
 # special variants
 if [[ $1 == "all" ]]; then
   expect perft.exp duck startpos 1 640 > /dev/null
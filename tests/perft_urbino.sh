@@ -0,0 +1,116 @@
+#!/bin/bash
+# verify Urbino perft numbers and move hashes, running the positions in parallel
+# usage (from the directory of the engine):
+#   ../tests/perft_urbino.sh                  -> check all positions
+#   ../tests/perft_urbino.sh list             -> list the positions by number
+#   ../tests/perft_urbino.sh divide <n> [d]   -> sorted divide of position n at depth d, for diffing two engines
+#   ../tests/perft_urbino.sh fuzz [games]     -> random games checking the fast Urbino structures
+# environment: STOCKFISH (default ./stockfish), JOBS (default number of CPUs)
+
+STOCKFISH=${STOCKFISH:-./stockfish}
+JOBS=${JOBS:-$(nproc 2>/dev/null || echo 2)}
+
+# variant;fen;nodes at depth 1;depth 2;depth 3 ('-' if too slow);move hash at the deepest depth
+POSITIONS=(
+  "urbino;9/9/9/9/9/9/9/9/9[TTTPPPPPPHHHHHHHHHHHHHHHHHHAtttpppppphhhhhhhhhhhhhhhhhha] w - - 0 1;81;12960;653568;220b4442f5c37892"
+  "urbino;9/9/9/6a2/9/9/A8/9/9[TTTPPPPPPHHHHHHHHHHHHHHHHHHtttpppppphhhhhhhhhhhhhhhhhh] b - - 1 2;15;42293;103722428;b23610363bb372bf"
+  "urbino;4p4/9/9/9/6P2/T8/4tpT2/5A3/4a4[TPPPPPHHHHHHHHHHHHHHHHHHttpppphhhhhhhhhhhhhhhhhh] w e - 6 5;868;985134;-;1b33689dfde2c472"
+  "urbino;9/7hP/4H1h1a/3hP1hH1/5h2h/6H2/9/9/4A4[TTTPPPPHHHHHHHHHHHHHHHtttpppppphhhhhhhhhhhh] w E - 12 8;810;1044040;-;17c85011a87fc289"
+  "urbino;5paT1/7p1/3HH1T2/P2T2p1A/t5h2/2h6/9/9/9[PPPPPHHHHHHHHHHHHHHHHttppphhhhhhhhhhhhhhhh] w fg - 12 8;254;226973;123764278;6eac73c34fe0fbc9"
+  "urbino;9/3t5/9/9/4hh3/4Ph3/hh1PHTP2/h2TP4/AhT2hP2[PHHHHHHHHHHHHHHHHHttpppppphhhhhhhhhha] w CG - 19 11;1657;3921691;-;e56d1ca1f26ade42"
+  "urbino;9/7hP/4H1h2/3hP1hH1/AtH2h2h/ap3TH2/P5H2/h2Hh4/1Hh1p4[TTPPPHHHHHHHHHHHttpppphhhhhhhhh] w B - 24 14;336;108099;32182663;09294c18299885d4"
+  "urbino;3ap4/1t3hP2/1h3PH2/1T1p2H2/P1hAt1PH1/T1P1p4/4tpT2/3H3h1/8h[PHHHHHHHHHHHHHHpphhhhhhhhhhhhh] w de - 24 14;49;3425;96744;fa35271ad915582e"
+  "urbino;2a1p4/1t1P1hP2/1hp1APH2/1T1ph1H2/P1h1t1PH1/T1P1p4/4tpT2/3H3h1/8h[HHHHHHHHHHHHHHphhhhhhhhhhhh] w ce - 28 16;5;42;42;1547f07b9114a508"
+  "urbino;3hh1HHH/3thh1Hh/2ph1phA1/hphp3HH/ptp1hhHH1/tP1HPhHHH/hh1PHTPHH/h2TP2HH/1hT2hP1H[ha] b CGIde - 54 28;46;46;46;6b08327249d1e057"
+  "urbino;AtaTh4/1pH4hP/H2tH1h2/H2hP1hH1/1tH2h2h/1p3TH2/P5H2/h2Hh4/1Hh1p4[TPPPHHHHHHHHppphhhhhhhhh] w Bbce - 32 18;1;1;0;4874b23258d9934c"
+  "monuments;9/7hP/4H1h2/3hP1hH1/a4h2h/6H2/6H2/h2Hh4/AHh6[TTTPPPPHHHHHHHHHHHHtttpppppphhhhhhhhh] w B - 18 11;663;520233;-;53c115c87b349e42"
+  "monuments;9/1pH4hP/2AtH1h2/Ha1hP1hH1/1tH2h2h/1p3TH2/P5H2/h2Hh4/1Hh1p4[TTPPPHHHHHHHHHtppphhhhhhhhh] w B - 28 16;78;5386;346573;41ed9093f87ab9f2"
+  "monuments;2a1h4/1pH4hP/H1AtH1h2/H2hP1hH1/1tH2h2h/1p3TH2/P5H2/h2Hh4/1Hh1p4[TTPPPHHHHHHHHtppphhhhhhhh] w Bce - 30 17;12;468;18828;ed58170eab16f9cd"
+)
+
+# perft <variant> <fen> <depth> -> output of "go perft", monuments needs variants.ini
+perft()
+{
+  printf "setoption name VariantPath value variants.ini\nsetoption name UCI_Variant value %s\nposition fen %s\ngo perft %s\nquit\n" \
+         "$1" "$2" "$3" | $STOCKFISH 2>&1
+}
+
+# check <n> -> prints one line with the result of position n
+check()
+{
+  IFS=';' read -r var fen d1 d2 d3 hash <<< "${POSITIONS[$1]}"
+  expected=("$d1" "$d2" "$d3")
+  for depth in 1 2 3; do
+    [[ ${expected[depth-1]} == "-" ]] && break
+    out=$(perft "$var" "$fen" $depth)
+    nodes=$(sed -n 's/^Nodes searched: //p' <<< "$out")
+    if [[ "$nodes" != "${expected[depth-1]}" ]]; then
+      echo "FAIL $1 ($var $fen) depth $depth: $nodes nodes, expected ${expected[depth-1]}"
+      return
+    fi
+    moves=$(sed -n 's/^Move hash: //p' <<< "$out")
+  done
+  if [[ "$moves" != "$hash" ]]; then
+    echo "FAIL $1 ($var $fen) depth $((depth - 1)): move hash $moves, expected $hash"
+  else
+    echo "ok $1"
+  fi
+}
+
+if [[ $1 == "list" ]]; then
+  for i in "${!POSITIONS[@]}"; do
+    IFS=';' read -r var fen rest <<< "${POSITIONS[$i]}"
+    echo "$i $var $fen"
+  done
+  exit 0
+fi
+
+if [[ $1 == "divide" ]]; then
+  IFS=';' read -r var fen rest <<< "${POSITIONS[$2]}"
+  perft "$var" "$fen" ${3:-2} | grep -E "^[^ ]+: [0-9]+$|^Nodes searched|^Move hash" | sort
+  exit 0
+fi
+
+# fuzz <variant> <games> -> output of the "fuzz" command, one random game per thread at a time
+fuzz()
+{
+  printf "setoption name VariantPath value variants.ini\nsetoption name UCI_Variant value %s\nsetoption name Threads value %s\nposition startpos\nfuzz games %s\nquit\n" \
+         "$1" "$JOBS" "$2" | $STOCKFISH 2>&1 | grep "^info string fuzz"
+}
+
+if [[ $1 == "fuzz" ]]; then
+  status=0
+  for var in urbino monuments; do
+    out=$(fuzz $var ${2:-10000})
+    echo "$out"
+    grep -q "no differences" <<< "$out" || status=1
+  done
+  exit $status
+fi
+
+echo "urbino perft testing started"
+
+results=$(mktemp -d)
+for i in "${!POSITIONS[@]}"; do
+  check $i > "$results/$i" &
+  while [[ $(jobs -rp | wc -l) -ge $JOBS ]]; do wait -n; done
+done
+wait
+
+failed=$(cat "$results"/* | grep "^FAIL")
+rm -r "$results"
+
+for var in urbino monuments; do
+  out=$(fuzz $var 100)
+  if ! grep -q "no differences" <<< "$out"; then
+    failed+=$'\n'"FAIL fuzz $var: $out"
+  fi
+done
+
+if [[ -n "$failed" ]]; then
+  echo "$failed"
+  echo "urbino perft testing failed"
+  exit 1
+fi
+
+echo "urbino perft testing OK"
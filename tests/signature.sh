@@ -1,6 +1,7 @@
 #!/bin/bash
 # obtain and optionally verify Bench / signature
 # if no reference is given, the output is deliberately limited to just the signature
+# an optional second argument selects the variant, e.g. ./signature.sh 3449245 urbino
 
 error()
 {
@@ -11,9 +12,9 @@ trap 'error ${LINENO}' ERR
 
 # obtain
 
-signature=`./stockfish bench 2>&1 | grep "Nodes searched  : " | awk '{print $4}'`
+signature=`./stockfish bench $2 2>&1 | grep "Nodes searched  : " | awk '{print $4}'`
 
-if [ $# -gt 0 ]; then
+if [ -n "$1" ]; then
    # compare to given reference
    if [ "$1" != "$signature" ]; then
       if [ -z "$signature" ]; then